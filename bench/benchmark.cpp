@@ -0,0 +1,113 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include "benchmark.hpp"
+#include <echrono/Steady.hpp>
+#include <test-debug/debug.hpp>
+#include <cstdlib>
+#include <new>
+
+static int64_t g_cppAllocation = 0;
+static int64_t g_luaAllocation = 0;
+// The benchmark use a single lua state: keep the instrumented allocator here.
+static lua_Alloc g_luaAllocator = null;
+static void* g_luaAllocatorData = null;
+
+void bench::countCppAllocation() {
+	++g_cppAllocation;
+}
+
+void* operator new(size_t _size) {
+	bench::countCppAllocation();
+	void* ptr = malloc(_size == 0 ? 1 : _size);
+	if (ptr == null) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void* _ptr) noexcept {
+	free(_ptr);
+}
+
+void operator delete(void* _ptr, size_t _size) noexcept {
+	free(_ptr);
+}
+
+static void* countingAllocator(void* _userData, void* _ptr, size_t _oldSize, size_t _newSize) {
+	if (    _newSize != 0
+	     && (    _ptr == null
+	          || _newSize > _oldSize)) {
+		++g_luaAllocation;
+	}
+	return g_luaAllocator(g_luaAllocatorData, _ptr, _oldSize, _newSize);
+}
+
+bench::Runner::Runner(int64_t _iterations, const etk::String& _filter) :
+  m_iterations(_iterations),
+  m_filter(_filter) {
+
+}
+
+void bench::Runner::instrument(lua_State* _luaState) {
+	g_luaAllocator = lua_getallocf(_luaState, &g_luaAllocatorData);
+	lua_setallocf(_luaState, countingAllocator, null);
+}
+
+void bench::Runner::run(const etk::String& _name, etk::Function<void(int64_t)> _function, double _scale) {
+	if (    m_filter.empty() == false
+	     && _name.find(m_filter) == etk::String::npos) {
+		return;
+	}
+	int64_t iterations = int64_t(double(m_iterations) * _scale);
+	if (iterations < 1) {
+		iterations = 1;
+	}
+	// warm up the caches (CPU and luaWrapper ones)
+	_function(iterations / 10 + 1);
+	int64_t cppAllocation = g_cppAllocation;
+	int64_t luaAllocation = g_luaAllocation;
+	echrono::Steady start = echrono::Steady::now();
+	_function(iterations);
+	echrono::Steady stop = echrono::Steady::now();
+	bench::Result result;
+	result.m_name = _name;
+	result.m_iterations = iterations;
+	result.m_nsPerOp = double((stop - start).get()) / double(iterations);
+	result.m_cppAllocationPerOp = double(g_cppAllocation - cppAllocation) / double(iterations);
+	result.m_luaAllocationPerOp = double(g_luaAllocation - luaAllocation) / double(iterations);
+	TEST_PRINT(_name << " : " << result.m_nsPerOp << " ns/op "
+	           << result.m_cppAllocationPerOp + result.m_luaAllocationPerOp << " alloc/op"
+	           << " (c++=" << result.m_cppAllocationPerOp << " lua=" << result.m_luaAllocationPerOp << ")");
+	m_results.pushBack(result);
+}
+
+etk::String bench::Runner::toJson() const {
+	etk::String out;
+	out += "{\n";
+	out += "\t\"library\": \"luaWrapper\",\n";
+	out += "\t\"lua\": \"" LUA_RELEASE "\",\n";
+	out += "\t\"iterations\": " + etk::toString(m_iterations) + ",\n";
+	out += "\t\"results\": [\n";
+	for (size_t iii=0; iii<m_results.size(); ++iii) {
+		const bench::Result& elem = m_results[iii];
+		out += "\t\t{";
+		out += "\"name\": \"" + elem.m_name + "\", ";
+		out += "\"iterations\": " + etk::toString(elem.m_iterations) + ", ";
+		out += "\"ns_per_op\": " + etk::toString(elem.m_nsPerOp) + ", ";
+		out += "\"allocations_per_op\": " + etk::toString(elem.m_cppAllocationPerOp + elem.m_luaAllocationPerOp) + ", ";
+		out += "\"cpp_allocations_per_op\": " + etk::toString(elem.m_cppAllocationPerOp) + ", ";
+		out += "\"lua_allocations_per_op\": " + etk::toString(elem.m_luaAllocationPerOp);
+		out += "}";
+		if (iii != m_results.size()-1) {
+			out += ",";
+		}
+		out += "\n";
+	}
+	out += "\t]\n";
+	out += "}\n";
+	return out;
+}
@@ -0,0 +1,65 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <etk/String.hpp>
+#include <etk/Vector.hpp>
+#include <etk/Function.hpp>
+#include <lua/lua.h>
+
+namespace bench {
+	/**
+	 * @brief Result of one benchmark case.
+	 */
+	class Result {
+		public:
+			etk::String m_name; //!< Name of the case (group.case).
+			int64_t m_iterations = 0; //!< Number of measured operations.
+			double m_nsPerOp = 0.0; //!< Mean time of one operation in nano-seconds.
+			double m_cppAllocationPerOp = 0.0; //!< Mean C++ heap allocation (operator new) of one operation.
+			double m_luaAllocationPerOp = 0.0; //!< Mean Lua allocator allocation of one operation.
+	};
+	/**
+	 * @brief Simple benchmark runner: time and count allocations of a set of cases.
+	 */
+	class Runner {
+		private:
+			int64_t m_iterations; //!< Default number of operations of a case.
+			etk::String m_filter; //!< Only run the case that contain this string.
+			etk::Vector<bench::Result> m_results; //!< All the results.
+		public:
+			Runner(int64_t _iterations, const etk::String& _filter);
+			/**
+			 * @brief Replace the allocator of a lua state with a counting one.
+			 * @param[in] _luaState State to instrument.
+			 */
+			static void instrument(lua_State* _luaState);
+			/**
+			 * @brief Run a case. The function must execute the operation the number of time requested.
+			 * @param[in] _name Name of the case.
+			 * @param[in] _function Function that run "N" operation.
+			 * @param[in] _scale Scale the number of iteration for the slow cases.
+			 */
+			void run(const etk::String& _name, etk::Function<void(int64_t)> _function, double _scale = 1.0);
+			/**
+			 * @brief Get all the results.
+			 * @return The list of results.
+			 */
+			const etk::Vector<bench::Result>& getResults() const {
+				return m_results;
+			}
+			/**
+			 * @brief Generate the machine readable report.
+			 * @return JSON document.
+			 */
+			etk::String toJson() const;
+	};
+	/**
+	 * @brief Register one allocation done in the C++ heap (called by the operator new).
+	 */
+	void countCppAllocation();
+}
@@ -0,0 +1,683 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <test-debug/debug.hpp>
+#include <etk/etk.hpp>
+#include <etk/os/FSNode.hpp>
+#include <luaWrapper/luaWrapper.hpp>
+#include <luaWrapper/luaWrapperUtil.hpp>
+#include <luaWrapper/PoolAllocator.hpp>
+#include <luaWrapper/VectorView.hpp>
+#include <luaWrapper/NumericArray.hpp>
+#include <luaWrapper/StructView.hpp>
+#include <luaWrapper/Symbol.hpp>
+
+#include "benchmark.hpp"
+
+class BenchObject {
+	public:
+		int m_value = 42;
+		int getValue() const {
+			return m_value;
+		}
+		void setValue(int _value) {
+			m_value = _value;
+		}
+		int add(int _value) {
+			m_value += _value;
+			return m_value;
+		}
+};
+
+class BenchDerived : public BenchObject {
+
+};
+
+class BenchLeaf : public BenchDerived {
+
+};
+
+class BenchSealed : public BenchObject {
+
+};
+
+class BenchVector {
+	public:
+		float m_x = 0.0f;
+		float m_y = 0.0f;
+		BenchVector(float _x = 0.0f, float _y = 0.0f) :
+		  m_x(_x),
+		  m_y(_y) {
+			
+		}
+};
+
+class BenchParticle {
+	public:
+		float m_x;
+		float m_speed;
+};
+
+ETK_DECLARE_TYPE(BenchObject);
+ETK_DECLARE_TYPE(BenchDerived);
+ETK_DECLARE_TYPE(BenchLeaf);
+ETK_DECLARE_TYPE(BenchSealed);
+ETK_DECLARE_TYPE(BenchVector);
+
+static luaL_Reg BenchObject_table[] = {
+	{ "gather", luaWrapper::gather<BenchObject> },
+	{ "scatter", luaWrapper::scatter<BenchObject> },
+	{ NULL, NULL }
+};
+
+static luaL_Reg BenchObject_metatable[] = {
+	{ "getValue", luaWrapper::utils::get<BenchObject, int, &BenchObject::m_value> },
+	{ "setValue", luaWrapper::utils::set<BenchObject, int, &BenchObject::m_value> },
+	{ "value", luaWrapper::utils::getSet<BenchObject, int, &BenchObject::m_value> },
+	{ "getValueFunc", luaWrapper::utils::get<BenchObject, int, &BenchObject::getValue> },
+	{ "setValueFunc", luaWrapper::utils::set<BenchObject, int, &BenchObject::setValue> },
+	{ "add", luaWrapperUtils_func(&BenchObject::add) },
+	{ NULL, NULL }
+};
+
+static luaWrapper::Property BenchObject_properties[] = {
+	{ "number", luaWrapper::utils::get<BenchObject, int, &BenchObject::m_value>, luaWrapper::utils::set<BenchObject, int, &BenchObject::m_value> },
+	{ NULL, NULL, NULL }
+};
+
+static int BenchVector_add(lua_State* _luaState) {
+	BenchVector& left = luaWrapper::checkValue<BenchVector>(_luaState, 1);
+	BenchVector& right = luaWrapper::checkValue<BenchVector>(_luaState, 2);
+	luaWrapper::emplaceValue<BenchVector>(_luaState, left.m_x + right.m_x, left.m_y + right.m_y);
+	return 1;
+}
+
+static luaL_Reg BenchVector_metatable[] = {
+	{ "x", luaWrapper::utils::getSetValue<BenchVector, float, &BenchVector::m_x> },
+	{ "y", luaWrapper::utils::getSetValue<BenchVector, float, &BenchVector::m_y> },
+	{ "__add", BenchVector_add },
+	{ NULL, NULL }
+};
+
+static luaWrapper::StructField BenchParticle_fields[] = {
+	LUAW_STRUCT_FIELD(BenchParticle, m_x, "x"),
+	LUAW_STRUCT_FIELD(BenchParticle, m_speed, "speed"),
+	{ NULL, 0, luaWrapper::StructFieldType::typeFloat }
+};
+
+static luaL_Reg BenchEmpty_metatable[] = {
+	{ NULL, NULL }
+};
+
+static void usage() {
+	TEST_PRINT("Help:");
+	TEST_PRINT("    ./xxx [OPTIONS] ---");
+	TEST_PRINT("        --output=XXX       JSON report file (default: lua-wrapper-bench.json)");
+	TEST_PRINT("        --iteration=XXX    Number of operation of each case (default: 1000000)");
+	TEST_PRINT("        --filter=XXX       Only run the cases that contain XXX");
+	exit(0);
+}
+
+/**
+ * @brief Call directly a lua C function with the current stack and clean the stack.
+ */
+static inline void callCFunction(lua_State* _luaState, lua_CFunction _function) {
+	_function(_luaState);
+	lua_settop(_luaState, 0);
+}
+
+static void benchPush(bench::Runner& _runner, lua_State* _luaState, int64_t _iterations) {
+	ememory::SharedPtr<BenchObject> object = ememory::makeShared<BenchObject>();
+	// Keep a reference on the userdata to be sure to stay in the cache.
+	luaWrapper::push<BenchObject>(_luaState, object);
+	lua_setglobal(_luaState, "benchPushCacheHit");
+	_runner.run("push.cacheHit", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				luaWrapper::push<BenchObject>(_luaState, object);
+				lua_pop(_luaState, 1);
+			}
+		});
+	// Pre-create all the objects to only measure the push.
+	etk::Vector<ememory::SharedPtr<BenchObject>> objects;
+	objects.resize(_iterations + _iterations / 10 + 1);
+	for (auto &it: objects) {
+		it = ememory::makeShared<BenchObject>();
+	}
+	size_t offset = 0;
+	_runner.run("push.cacheMiss", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				luaWrapper::push<BenchObject>(_luaState, objects[offset++ % objects.size()]);
+				lua_pop(_luaState, 1);
+			}
+		});
+	lua_pushnil(_luaState);
+	lua_setglobal(_luaState, "benchPushCacheHit");
+	objects.clear();
+	lua_gc(_luaState, LUA_GCCOLLECT, 0);
+}
+
+static void benchCheck(bench::Runner& _runner, lua_State* _luaState) {
+	ememory::SharedPtr<BenchObject> object = ememory::makeShared<BenchObject>();
+	ememory::SharedPtr<BenchLeaf> leaf = ememory::makeShared<BenchLeaf>();
+	luaWrapper::push<BenchObject>(_luaState, object); // object
+	luaWrapper::push<BenchLeaf>(_luaState, leaf); // object leaf
+	_runner.run("is.direct", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				if (luaWrapper::is<BenchObject>(_luaState, 1) == false) {
+					TEST_ERROR("wrong type");
+				}
+			}
+		});
+	_runner.run("is.extend", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				if (luaWrapper::is<BenchObject>(_luaState, 2) == false) {
+					TEST_ERROR("wrong type");
+				}
+			}
+		});
+	_runner.run("is.mismatch", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				if (luaWrapper::is<BenchLeaf>(_luaState, 1) == true) {
+					TEST_ERROR("wrong type");
+				}
+			}
+		});
+	_runner.run("check.direct", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				luaWrapper::check<BenchObject>(_luaState, 1);
+			}
+		});
+	_runner.run("check.extend", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				luaWrapper::check<BenchObject>(_luaState, 2);
+			}
+		});
+	lua_settop(_luaState, 0);
+}
+
+static void benchIndex(bench::Runner& _runner, lua_State* _luaState) {
+	ememory::SharedPtr<BenchObject> object = ememory::makeShared<BenchObject>();
+	luaWrapper::push<BenchObject>(_luaState, object); // obj
+	lua_setglobal(_luaState, "benchIndexObject");
+	_runner.run("index.method", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				lua_getglobal(_luaState, "benchIndexObject"); // obj
+				lua_pushliteral(_luaState, "getValue"); // obj key
+				callCFunction(_luaState, luaWrapper::index<BenchObject>);
+			}
+		});
+	_runner.run("newindex", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				lua_getglobal(_luaState, "benchIndexObject"); // obj
+				lua_pushliteral(_luaState, "field"); // obj key
+				lua_pushinteger(_luaState, lua_Integer(iii)); // obj key value
+				callCFunction(_luaState, luaWrapper::newindex<BenchObject>);
+			}
+		});
+	_runner.run("index.storage", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				lua_getglobal(_luaState, "benchIndexObject"); // obj
+				lua_pushliteral(_luaState, "field"); // obj key
+				callCFunction(_luaState, luaWrapper::index<BenchObject>);
+			}
+		});
+	lua_pushnil(_luaState);
+	lua_setglobal(_luaState, "benchIndexObject");
+}
+
+static void benchCall(bench::Runner& _runner, luaWrapper::Lua& _lua) {
+	_lua.executeString(R"#(
+	function benchAdd(x, y)
+		return x + y
+	end
+	function benchVoid(x, y)
+	end
+	)#");
+	_runner.run("Lua.call", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				_lua.call<int>("benchAdd", 43, 76);
+			}
+		});
+	_runner.run("Lua.callVoid", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				_lua.callVoid("benchVoid", 43, 76);
+			}
+		});
+}
+
+static void benchCreate(bench::Runner& _runner, lua_State* _luaState) {
+	_runner.run("create", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				luaWrapper::create<BenchObject>(_luaState, 0);
+				lua_settop(_luaState, 0);
+			}
+			lua_gc(_luaState, LUA_GCCOLLECT, 0);
+		}, 0.1);
+}
+
+static void benchUtils(bench::Runner& _runner, lua_State* _luaState) {
+	ememory::SharedPtr<BenchObject> object = ememory::makeShared<BenchObject>();
+	luaWrapper::push<BenchObject>(_luaState, object); // obj
+	lua_setglobal(_luaState, "benchUtilsObject");
+	_runner.run("utils.get.member", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				lua_getglobal(_luaState, "benchUtilsObject");
+				callCFunction(_luaState, luaWrapper::utils::get<BenchObject, int, &BenchObject::m_value>);
+			}
+		});
+	_runner.run("utils.set.member", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				lua_getglobal(_luaState, "benchUtilsObject");
+				lua_pushinteger(_luaState, 12);
+				callCFunction(_luaState, luaWrapper::utils::set<BenchObject, int, &BenchObject::m_value>);
+			}
+		});
+	_runner.run("utils.getSet.get", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				lua_getglobal(_luaState, "benchUtilsObject");
+				callCFunction(_luaState, luaWrapper::utils::getSet<BenchObject, int, &BenchObject::m_value>);
+			}
+		});
+	_runner.run("utils.getSet.set", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				lua_getglobal(_luaState, "benchUtilsObject");
+				lua_pushinteger(_luaState, 12);
+				callCFunction(_luaState, luaWrapper::utils::getSet<BenchObject, int, &BenchObject::m_value>);
+			}
+		});
+	_runner.run("utils.get.getter", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				lua_getglobal(_luaState, "benchUtilsObject");
+				callCFunction(_luaState, luaWrapper::utils::get<BenchObject, int, &BenchObject::getValue>);
+			}
+		});
+	_runner.run("utils.set.setter", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				lua_getglobal(_luaState, "benchUtilsObject");
+				lua_pushinteger(_luaState, 12);
+				callCFunction(_luaState, luaWrapper::utils::set<BenchObject, int, &BenchObject::setValue>);
+			}
+		});
+	_runner.run("utils.MemberFuncWrapper", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				lua_getglobal(_luaState, "benchUtilsObject");
+				lua_pushinteger(_luaState, 1);
+				callCFunction(_luaState, luaWrapperUtils_func(&BenchObject::add));
+			}
+		});
+	lua_pushnil(_luaState);
+	lua_setglobal(_luaState, "benchUtilsObject");
+}
+
+static void benchScript(bench::Runner& _runner, luaWrapper::Lua& _lua) {
+	// Full path: lua VM + __index + method wrapper.
+	_lua.executeString(R"#(
+	benchScriptObject = BenchObject.new()
+	function benchScriptLoop(count)
+		local obj = benchScriptObject
+		for iii=1,count do
+			obj:setValue(obj:getValue() + 1)
+		end
+	end
+	)#");
+	_runner.run("script.methodCall", [&](int64_t _count) {
+			_lua.callVoid("benchScriptLoop", int(_count));
+		});
+	// Same with a sealed type: the methods are found without any C __index.
+	_lua.executeString(R"#(
+	benchScriptSealed = BenchSealed.new()
+	function benchScriptSealedLoop(count)
+		local obj = benchScriptSealed
+		for iii=1,count do
+			obj:setValue(obj:getValue() + 1)
+		end
+	end
+	)#");
+	_runner.run("script.methodCall.sealed", [&](int64_t _count) {
+			_lua.callVoid("benchScriptSealedLoop", int(_count));
+		});
+	// Same with a property: obj.number instead of obj:getValue()/obj:setValue().
+	_lua.executeString(R"#(
+	function benchScriptPropertyLoop(count)
+		local obj = benchScriptObject
+		for iii=1,count do
+			obj.number = obj.number + 1
+		end
+	end
+	)#");
+	_runner.run("script.property", [&](int64_t _count) {
+			_lua.callVoid("benchScriptPropertyLoop", int(_count));
+		});
+}
+
+static void benchValue(bench::Runner& _runner, luaWrapper::Lua& _lua) {
+	lua_State* luaState = _lua.getState();
+	_runner.run("value.push", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				luaWrapper::pushValue<BenchVector>(luaState, BenchVector(1.0f, 2.0f));
+				lua_pop(luaState, 1);
+			}
+		});
+	// Temporary vectors created by a script.
+	_lua.executeString(R"#(
+	function benchValueLoop(count)
+		local pos = BenchVector.new()
+		local speed = BenchVector.new()
+		speed:x(1)
+		for iii=1,count do
+			pos = pos + speed
+		end
+		return pos:x()
+	end
+	)#");
+	_runner.run("value.script", [&](int64_t _count) {
+			_lua.call<float>("benchValueLoop", int(_count));
+		});
+}
+
+static void benchContainer(bench::Runner& _runner, lua_State* _luaState) {
+	etk::Vector<int> list;
+	for (int iii=0; iii<10000; ++iii) {
+		list.pushBack(iii);
+	}
+	// One operation is the transfer of a 10k elements array.
+	_runner.run("container.vector.push", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				luaWrapper::utils::push<etk::Vector<int>>(_luaState, list);
+				lua_pop(_luaState, 1);
+			}
+		}, 0.001);
+	luaWrapper::utils::push<etk::Vector<int>>(_luaState, list); // list
+	_runner.run("container.vector.check", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				etk::Vector<int> out = luaWrapper::utils::check<etk::Vector<int>>(_luaState, -1);
+			}
+		}, 0.001);
+	lua_settop(_luaState, 0);
+	// A script that read 2 elements: copy of the array or view.
+	luaL_dostring(_luaState, "function benchContainerRead(list) return list[1] + list[#list] end");
+	_runner.run("container.read.copy", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				lua_getglobal(_luaState, "benchContainerRead"); // func
+				luaWrapper::utils::push<etk::Vector<int>>(_luaState, list); // func list
+				lua_call(_luaState, 1, 1); // ret
+				lua_pop(_luaState, 1);
+			}
+		}, 0.001);
+	_runner.run("container.read.view", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				lua_getglobal(_luaState, "benchContainerRead"); // func
+				luaWrapper::pushView<int>(_luaState, list); // func view
+				lua_call(_luaState, 1, 1); // ret
+				lua_pop(_luaState, 1);
+			}
+		}, 0.001);
+}
+
+static void benchNumeric(bench::Runner& _runner, luaWrapper::Lua& _lua) {
+	// One operation is the sum (or dot) of 10k elements: lua loop on a table or kernel.
+	_lua.executeString(R"#(
+	benchNumericTable = {}
+	for iii=1,10000 do
+		benchNumericTable[iii] = iii * 0.5
+	end
+	benchNumericArray = Float32Array.new(benchNumericTable)
+	function benchNumericTableSum(count)
+		local list = benchNumericTable
+		local out = 0
+		for jjj=1,count do
+			for iii=1,#list do
+				out = out + list[iii]
+			end
+		end
+		return out
+	end
+	function benchNumericArraySum(count)
+		local out = 0
+		for jjj=1,count do
+			out = out + benchNumericArray:sum()
+		end
+		return out
+	end
+	function benchNumericArrayDot(count)
+		local out = 0
+		for jjj=1,count do
+			out = out + benchNumericArray:dot(benchNumericArray)
+		end
+		return out
+	end
+	)#");
+	_runner.run("numeric.sum.table", [&](int64_t _count) {
+			_lua.call<double>("benchNumericTableSum", int(_count));
+		}, 0.001);
+	_runner.run("numeric.sum.array", [&](int64_t _count) {
+			_lua.call<double>("benchNumericArraySum", int(_count));
+		}, 0.001);
+	_runner.run("numeric.dot.array", [&](int64_t _count) {
+			_lua.call<double>("benchNumericArrayDot", int(_count));
+		}, 0.001);
+}
+
+static void benchStruct(bench::Runner& _runner, luaWrapper::Lua& _lua) {
+	etk::Vector<BenchParticle> particles;
+	particles.resize(10000);
+	for (size_t iii=0; iii<particles.size(); ++iii) {
+		particles[iii].m_x = 0.0f;
+		particles[iii].m_speed = 1.0f;
+	}
+	luaWrapper::pushStructView<BenchParticle>(_lua.getState(), particles);
+	lua_setglobal(_lua.getState(), "benchStructParticles");
+	// One operation is the update of 10k records, from a table of tables or from the view.
+	_lua.executeString(R"#(
+	benchStructTable = {}
+	for iii=1,10000 do
+		benchStructTable[iii] = { x = 0, speed = 1 }
+	end
+	function benchStructLoop(list, count)
+		for jjj=1,count do
+			for iii=1,#list do
+				local p = list[iii]
+				p.x = p.x + p.speed
+			end
+		end
+	end
+	)#");
+	_runner.run("struct.update.table", [&](int64_t _count) {
+			lua_getglobal(_lua.getState(), "benchStructLoop"); // func
+			lua_getglobal(_lua.getState(), "benchStructTable"); // func list
+			lua_pushinteger(_lua.getState(), _count); // func list count
+			lua_call(_lua.getState(), 2, 0);
+		}, 0.001);
+	_runner.run("struct.update.view", [&](int64_t _count) {
+			lua_getglobal(_lua.getState(), "benchStructLoop"); // func
+			lua_getglobal(_lua.getState(), "benchStructParticles"); // func view
+			lua_pushinteger(_lua.getState(), _count); // func view count
+			lua_call(_lua.getState(), 2, 0);
+		}, 0.001);
+	lua_pushnil(_lua.getState());
+	lua_setglobal(_lua.getState(), "benchStructParticles");
+}
+
+static void benchGather(bench::Runner& _runner, luaWrapper::Lua& _lua) {
+	// One operation is the read (or write) of a property on 5k objects.
+	_lua.executeString(R"#(
+	benchGatherList = {}
+	for iii=1,5000 do
+		benchGatherList[iii] = BenchObject.new()
+	end
+	benchGatherOut = {}
+	function benchGatherScript(count)
+		local list = benchGatherList
+		local out = benchGatherOut
+		for jjj=1,count do
+			for iii=1,#list do
+				out[iii] = list[iii].number
+			end
+		end
+	end
+	function benchGatherBulk(count)
+		for jjj=1,count do
+			BenchObject.gather(benchGatherList, "number", benchGatherOut)
+		end
+	end
+	function benchScatterBulk(count)
+		for jjj=1,count do
+			BenchObject.scatter(benchGatherList, "number", benchGatherOut)
+		end
+	end
+	)#");
+	_runner.run("property.gather.script", [&](int64_t _count) {
+			_lua.callVoid("benchGatherScript", int(_count));
+		}, 0.001);
+	_runner.run("property.gather.bulk", [&](int64_t _count) {
+			_lua.callVoid("benchGatherBulk", int(_count));
+		}, 0.001);
+	_runner.run("property.scatter.bulk", [&](int64_t _count) {
+			_lua.callVoid("benchScatterBulk", int(_count));
+		}, 0.001);
+	_lua.executeString("benchGatherList = nil benchGatherOut = nil");
+}
+
+static void benchString(bench::Runner& _runner, lua_State* _luaState) {
+	// A 4KB log line.
+	etk::String line;
+	for (int iii=0; iii<4096; ++iii) {
+		line.pushBack(char('a' + iii%26));
+	}
+	_runner.run("string.push", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				luaWrapper::utils::push<etk::String>(_luaState, line);
+				lua_pop(_luaState, 1);
+			}
+		});
+	luaWrapper::utils::push<etk::String>(_luaState, line); // line
+	// The size is summed: the view can not be optimized out.
+	size_t size = 0;
+	_runner.run("string.check.copy", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				size += luaWrapper::utils::check<etk::String>(_luaState, -1).size();
+			}
+		});
+	_runner.run("string.check.view", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				size += luaWrapper::utils::check<luaWrapper::StringView>(_luaState, -1).size();
+			}
+		});
+	lua_settop(_luaState, 0);
+	TEST_INFO("string: " << size << " bytes checked");
+}
+
+static void benchSymbol(bench::Runner& _runner, lua_State* _luaState) {
+	// Dispatch on an event name: map of strings or symbol.
+	etk::Map<etk::String, int> events;
+	events.add("click", 0);
+	events.add("hover", 1);
+	events.add("press", 2);
+	events.add("release", 3);
+	luaWrapper::internSymbol(_luaState, "click");
+	luaWrapper::internSymbol(_luaState, "hover");
+	luaWrapper::internSymbol(_luaState, "press");
+	luaWrapper::internSymbol(_luaState, "release");
+	lua_pushstring(_luaState, "press"); // name
+	size_t sum = 0;
+	_runner.run("symbol.dispatch.map", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				sum += events[luaWrapper::utils::check<etk::String>(_luaState, -1)];
+			}
+		});
+	_runner.run("symbol.dispatch.symbol", [&](int64_t _count) {
+			for (int64_t iii=0; iii<_count; ++iii) {
+				sum += luaWrapper::utils::check<luaWrapper::Symbol>(_luaState, -1).getId();
+			}
+		});
+	lua_settop(_luaState, 0);
+	TEST_INFO("symbol: " << sum);
+}
+
+static void benchAllocator(bench::Runner& _runner, luaWrapper::Lua& _lua, const etk::String& _name) {
+	// Small blocks churn: tables, strings and closures.
+	_lua.executeString(R"#(
+	function benchAllocatorLoop(count)
+		for iii=1,count do
+			local value = { x = iii, name = "elem" .. iii, f = function() return iii end }
+		end
+	end
+	)#");
+	_runner.run("allocator." + _name, [&](int64_t _count) {
+			_lua.callVoid("benchAllocatorLoop", int(_count));
+		}, 0.1);
+}
+
+int main(int _argc, const char *_argv[]) {
+	etk::init(_argc, _argv);
+	etk::String outputFileName = "lua-wrapper-bench.json";
+	etk::String filter;
+	int64_t iterations = 1000000;
+	for (int32_t iii=0; iii<_argc ; ++iii) {
+		etk::String data = _argv[iii];
+		if (    data == "-h"
+		     || data == "--help") {
+			usage();
+		} else if (data.startWith("--output=") == true) {
+			outputFileName = etk::String(&_argv[iii][9]);
+		} else if (data.startWith("--iteration=") == true) {
+			iterations = atoll(&_argv[iii][12]);
+		} else if (data.startWith("--filter=") == true) {
+			filter = etk::String(&_argv[iii][9]);
+		}
+	}
+	bench::Runner runner(iterations, filter);
+	{
+		luaWrapper::Lua lua;
+		lua_State* luaState = lua.getState();
+		bench::Runner::instrument(luaState);
+		luaWrapper::registerElement<BenchObject>(lua, "BenchObject", BenchObject_table, BenchObject_metatable);
+		luaWrapper::registerElement<BenchDerived>(lua, "BenchDerived", NULL, BenchEmpty_metatable);
+		luaWrapper::registerElement<BenchLeaf>(lua, "BenchLeaf", NULL, BenchEmpty_metatable);
+		luaWrapper::registerValue<BenchVector>(lua, "BenchVector", NULL, BenchVector_metatable);
+		luaWrapper::extend<BenchDerived, BenchObject>(luaState);
+		luaWrapper::extend<BenchLeaf, BenchDerived>(luaState);
+		luaWrapper::registerElement<BenchSealed>(lua, "BenchSealed", NULL, BenchEmpty_metatable);
+		luaWrapper::extend<BenchSealed, BenchObject>(luaState);
+		luaWrapper::seal<BenchSealed>(luaState);
+		// After seal: BenchSealed keep its table __index (it does not inherit the properties).
+		luaWrapper::setProperties<BenchObject>(luaState, BenchObject_properties);
+		luaWrapper::registerNumericArrays(lua);
+		luaWrapper::registerStruct<BenchParticle>(luaState, BenchParticle_fields);
+		lua_settop(luaState, 0);
+		benchPush(runner, luaState, iterations);
+		benchCheck(runner, luaState);
+		benchIndex(runner, luaState);
+		benchCall(runner, lua);
+		benchCreate(runner, luaState);
+		benchUtils(runner, luaState);
+		benchScript(runner, lua);
+		benchValue(runner, lua);
+		benchContainer(runner, luaState);
+		benchNumeric(runner, lua);
+		benchStruct(runner, lua);
+		benchGather(runner, lua);
+		benchString(runner, luaState);
+		benchSymbol(runner, luaState);
+	}
+	{
+		luaWrapper::Lua lua;
+		benchAllocator(runner, lua, "system");
+	}
+	{
+		luaWrapper::PoolAllocator allocator;
+		{
+			luaWrapper::Lua lua(luaWrapper::PoolAllocator::allocate, &allocator);
+			benchAllocator(runner, lua, "pool");
+		}
+		const luaWrapper::PoolAllocator::Statistic& statistic = allocator.getStatistic();
+		TEST_PRINT("pool allocator: " << statistic.m_poolAllocation << " pool / " << statistic.m_systemAllocation
+		           << " system allocations, peak=" << statistic.m_peakSize << " bytes");
+	}
+	etk::FSNodeWriteAllData(outputFileName, runner.toJson());
+	TEST_PRINT("Report written in: " << outputFileName);
+	return 0;
+}
@@ -0,0 +1,97 @@
+/** @file
+ * @author Edouard DUPIN
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/AllocationProfiler.hpp>
+
+namespace {
+	//! Number of stack levels checked to find a lua function (the running one can be a C function).
+	const int g_maxStackDepth = 8;
+}
+
+void luaWrapper::AllocationProfiler::updateLocation(lua_State* _luaState, lua_Debug* _info) {
+	// The function that returns is still at the level 0.
+	int level = _info->event == LUA_HOOKRET ? 1 : 0;
+	lua_Debug info;
+	for (; level<g_maxStackDepth; ++level) {
+		if (lua_getstack(_luaState, level, &info) == 0) {
+			break;
+		}
+		if (    lua_getinfo(_luaState, "Sl", &info) != 0
+		     && info.currentline >= 0) {
+			m_location = etk::String(info.short_src) + ":" + etk::toString(info.currentline);
+			return;
+		}
+	}
+	m_location = "[C]";
+}
+
+size_t luaWrapper::AllocationProfiler::getSite(const char* _scope) {
+	etk::String name = m_location;
+	if (_scope != null) {
+		name = etk::String("[") + _scope + "] " + name;
+	}
+	auto it = m_siteIndex.find(name);
+	if (it != m_siteIndex.end()) {
+		return it->second;
+	}
+	AllocationSite site;
+	site.m_name = name;
+	m_sites.pushBack(site);
+	m_siteIndex.add(name, m_sites.size() - 1);
+	return m_sites.size() - 1;
+}
+
+void luaWrapper::AllocationProfiler::record(const char* _scope, void* _ptr, size_t _oldSize, void* _newPtr, size_t _newSize) {
+	// A reallocation is a free of the old block and an allocation on the current site.
+	if (_ptr != null) {
+		auto it = m_blocks.find(_ptr);
+		if (it != m_blocks.end()) {
+			AllocationSite& site = m_sites[it->second];
+			site.m_liveSize -= _oldSize;
+			site.m_liveCount--;
+			m_blocks.remove(_ptr);
+		}
+	}
+	if (    _newPtr == null
+	     || _newSize == 0) {
+		return;
+	}
+	size_t index = getSite(_scope);
+	AllocationSite& site = m_sites[index];
+	site.m_liveSize += _newSize;
+	site.m_liveCount++;
+	site.m_totalSize += _newSize;
+	site.m_totalCount++;
+	m_blocks.add(_newPtr, index);
+}
+
+etk::String luaWrapper::AllocationProfiler::getReport() const {
+	// Sort by live size, then by total size (insertion: the number of sites is small).
+	etk::Vector<const AllocationSite*> sites;
+	for (auto &it: m_sites) {
+		size_t position = sites.size();
+		while (    position > 0
+		        && (    sites[position-1]->m_liveSize < it.m_liveSize
+		             || (    sites[position-1]->m_liveSize == it.m_liveSize
+		                  && sites[position-1]->m_totalSize < it.m_totalSize))) {
+			--position;
+		}
+		sites.insert(position, &it);
+	}
+	etk::String out = "live bytes\tlive count\ttotal bytes\ttotal count\tsite\n";
+	for (auto &it: sites) {
+		out += etk::toString(it->m_liveSize) + "\t" + etk::toString(it->m_liveCount) + "\t"
+		       + etk::toString(it->m_totalSize) + "\t" + etk::toString(it->m_totalCount) + "\t"
+		       + it->m_name + "\n";
+	}
+	return out;
+}
+
+void luaWrapper::AllocationProfiler::clear() {
+	m_sites.clear();
+	m_siteIndex.clear();
+	m_blocks.clear();
+}
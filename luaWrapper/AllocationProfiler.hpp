@@ -0,0 +1,79 @@
+/** @file
+ * @author Edouard DUPIN
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <etk/String.hpp>
+#include <etk/Vector.hpp>
+#include <etk/Map.hpp>
+#include <lua/lua.h>
+
+namespace luaWrapper {
+	/**
+	 * Memory allocated from a site (a line of script, or a bound type pushed
+	 * or created from this line).
+	 */
+	class AllocationSite {
+		public:
+			etk::String m_name; //!< "source:line", "[classname] source:line" or "[C]"
+			uint64_t m_liveSize = 0; //!< Bytes of the blocks still allocated.
+			uint64_t m_liveCount = 0; //!< Number of blocks still allocated.
+			uint64_t m_totalSize = 0; //!< Bytes allocated since the start of the profiling.
+			uint64_t m_totalCount = 0; //!< Number of blocks allocated since the start of the profiling.
+	};
+	/**
+	 * Attribute the allocations of a state to their site. It is used by the
+	 * allocator of luaWrapper::Lua when the profiling is enabled
+	 * (Lua::setAllocationProfiling): it is slow, do not use it in production.
+	 *
+	 * The site is the current line of the first lua function of the running
+	 * stack. The lua VM can not be inspected from the allocator (the stack
+	 * can be in reallocation): the location is updated by a line/call/return
+	 * hook (updateLocation) and only read by record. The blocks allocated in
+	 * push<T> and create<T> are tagged with the name of the type.
+	 */
+	class AllocationProfiler {
+		private:
+			etk::Vector<AllocationSite> m_sites;
+			etk::Map<etk::String, size_t> m_siteIndex; //!< name -> index in m_sites
+			etk::Map<void*, size_t> m_blocks; //!< live block -> index in m_sites (the blocks allocated before the profiling are ignored)
+			etk::String m_location = "[C]"; //!< "source:line" of the running lua function (set by updateLocation)
+		public:
+			/**
+			 * Update the current location from a lua hook (lua_sethook with
+			 * LUA_MASKLINE, LUA_MASKCALL and LUA_MASKRET).
+			 * @param[in] _luaState Thread that run the hook.
+			 * @param[in] _info Event of the hook.
+			 */
+			void updateLocation(lua_State* _luaState, lua_Debug* _info);
+			/**
+			 * Register an allocation, a reallocation or a free of the state
+			 * (called from the allocator: it does not use the lua API).
+			 * @param[in] _scope Name of the type pushed (or NULL).
+			 * @param[in] _ptr Old block (or NULL).
+			 * @param[in] _oldSize Size of the old block.
+			 * @param[in] _newPtr New block (or NULL).
+			 * @param[in] _newSize Size of the new block.
+			 */
+			void record(const char* _scope, void* _ptr, size_t _oldSize, void* _newPtr, size_t _newSize);
+			/**
+			 * Get all the sites (not sorted).
+			 */
+			const etk::Vector<AllocationSite>& getSites() const {
+				return m_sites;
+			}
+			/**
+			 * Generate a text report of the sites, sorted by live size.
+			 */
+			etk::String getReport() const;
+			/**
+			 * Remove all the sites and forget the blocks.
+			 */
+			void clear();
+		private:
+			size_t getSite(const char* _scope);
+	};
+}
@@ -0,0 +1,374 @@
+/** @file
+ * @author Edouard DUPIN
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <luaWrapper/debug.hpp>
+#include <etk/os/FSNode.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace {
+	/**
+	 * Header of a cached bytecode file. The chunk is only used if all the fields
+	 * match the current source (the name already contain the hash, this protect
+	 * against collision and truncated files).
+	 */
+	struct BytecodeHeader {
+		char m_magic[8];
+		uint32_t m_luaVersion;
+		uint32_t m_strip;
+		uint64_t m_sourceHash;
+		uint64_t m_sourceSize;
+		uint64_t m_chunkNameHash; //!< Hash of the chunk name stored in the debug information (0 if stripped).
+		uint64_t m_bytecodeSize;
+	};
+	const char g_bytecodeMagic[8] = {'L', 'U', 'A', 'W', 'B', 'C', '2', '\0'};
+
+	const size_t g_readBlockSize = 64*1024;
+	const uint64_t g_hashInit = 14695981039346656037ULL;
+	
+	/**
+	 * Add data to a FNV-1a 64 bits hash.
+	 */
+	uint64_t hashAdd(uint64_t _hash, const char* _data, size_t _size) {
+		for (size_t iii=0; iii<_size; ++iii) {
+			_hash ^= uint8_t(_data[iii]);
+			_hash *= 1099511628211ULL;
+		}
+		return _hash;
+	}
+	
+	/**
+	 * lua_Reader that stream a file by fixed size blocks (and hash it with
+	 * FNV-1a 64 bits on the fly).
+	 */
+	class FileReader {
+		private:
+			etk::FSNode m_node;
+			etk::Vector<char> m_buffer;
+			bool m_open;
+			uint64_t m_hash = g_hashInit;
+			uint64_t m_size = 0;
+		public:
+			FileReader(const etk::String& _fileName) :
+			  m_node(_fileName) {
+				m_open = m_node.exist() == true
+				         && m_node.fileOpenRead() == true;
+				if (m_open == true) {
+					m_buffer.resize(g_readBlockSize);
+				}
+			}
+			~FileReader() {
+				if (m_open == true) {
+					m_node.fileClose();
+				}
+			}
+			bool isOpen() const {
+				return m_open;
+			}
+			/**
+			 * Read the next block.
+			 * @param[out] _size Size of the block (0 at the end of the file).
+			 * @return Pointer on the block.
+			 */
+			const char* readBlock(size_t& _size) {
+				int64_t size = m_node.fileRead(&m_buffer[0], 1, m_buffer.size());
+				_size = size > 0 ? size_t(size) : 0;
+				m_hash = hashAdd(m_hash, &m_buffer[0], _size);
+				m_size += _size;
+				return &m_buffer[0];
+			}
+			uint64_t getHash() const {
+				return m_hash;
+			}
+			uint64_t getSize() const {
+				return m_size;
+			}
+			static const char* reader(lua_State* _luaState, void* _userData, size_t* _size) {
+				return static_cast<FileReader*>(_userData)->readBlock(*_size);
+			}
+	};
+	
+	/**
+	 * Hash (FNV-1a 64 bits) of a file, without keeping its content in memory.
+	 * @return false if the file can not be read.
+	 */
+	bool hashFile(const etk::String& _fileName, uint64_t& _hash, uint64_t& _size) {
+		FileReader file(_fileName);
+		if (file.isOpen() == false) {
+			return false;
+		}
+		size_t size = 0;
+		do {
+			file.readBlock(size);
+		} while (size != 0);
+		_hash = file.getHash();
+		_size = file.getSize();
+		return true;
+	}
+
+	/**
+	 * Display and remove the error message of a failed load/pcall.
+	 * @throw luaWrapper::MemoryError The error is a memory error (the scripts errors are only displayed).
+	 */
+	void reportError(lua_State* _luaState, int _ret) {
+		etk::String error = lua_tostring(_luaState, -1);
+		lua_pop(_luaState, 1);
+		LUAW_PRINT(error);
+		if (_ret == LUA_ERRMEM) {
+			ETK_THROW_EXCEPTION(luaWrapper::MemoryError(error));
+		}
+	}
+
+	etk::String toHexa(uint64_t _value) {
+		static const char* digit = "0123456789abcdef";
+		etk::String out;
+		for (int32_t iii=60; iii>=0; iii-=4) {
+			out += digit[(_value >> iii) & 0xF];
+		}
+		return out;
+	}
+
+	int bytecodeWriter(lua_State* _luaState, const void* _data, size_t _size, void* _userData) {
+		etk::Vector<char>* buffer = static_cast<etk::Vector<char>*>(_userData);
+		const char* data = static_cast<const char*>(_data);
+		for (size_t iii=0; iii<_size; ++iii) {
+			buffer->pushBack(data[iii]);
+		}
+		return 0;
+	}
+
+	/**
+	 * Load the cached chunk (if it exist and match the source).
+	 * @return true if the chunk has been pushed on the stack.
+	 */
+	bool loadBytecodeCache(lua_State* _luaState, const etk::String& _cacheFileName, const BytecodeHeader& _reference, const etk::String& _chunkName) {
+		etk::FSNode node(_cacheFileName);
+		if (    node.exist() == false
+		     || node.fileOpenRead() == false) {
+			return false;
+		}
+		BytecodeHeader header;
+		etk::Vector<char> bytecode;
+		bool valid = node.fileRead(&header, sizeof(BytecodeHeader), 1) == 1
+		             && memcmp(header.m_magic, _reference.m_magic, sizeof(header.m_magic)) == 0
+		             && header.m_luaVersion == _reference.m_luaVersion
+		             && header.m_strip == _reference.m_strip
+		             && header.m_sourceHash == _reference.m_sourceHash
+		             && header.m_sourceSize == _reference.m_sourceSize
+		             && header.m_chunkNameHash == _reference.m_chunkNameHash
+		             && header.m_bytecodeSize != 0;
+		if (valid == true) {
+			bytecode.resize(header.m_bytecodeSize);
+			valid = node.fileRead(&bytecode[0], 1, header.m_bytecodeSize) == int64_t(header.m_bytecodeSize);
+		}
+		node.fileClose();
+		if (valid == false) {
+			return false;
+		}
+		if (luaL_loadbufferx(_luaState, &bytecode[0], bytecode.size(), _chunkName.c_str(), "b") != LUA_OK) {
+			LUAW_WARNING("Invalid bytecode cache '" << _cacheFileName << "': " << lua_tostring(_luaState, -1));
+			lua_pop(_luaState, 1);
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Name of a temporary file next to the cache file, unique for the
+	 * threads and the processes that store the same chunk.
+	 */
+	etk::String temporaryFileName(const etk::String& _cacheFileName) {
+		static std::atomic<uint64_t> g_counter(0);
+		uint64_t unique = uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+		unique ^= uint64_t(std::hash<std::thread::id>()(std::this_thread::get_id())) * 1099511628211ULL;
+		unique += g_counter++;
+		return _cacheFileName + "." + toHexa(unique) + ".tmp";
+	}
+
+	/**
+	 * Dump the function on the top of the stack in the cache. The file is
+	 * written in a temporary file renamed on the cache file: a reader never
+	 * see a partial file.
+	 */
+	void storeBytecodeCache(lua_State* _luaState, const etk::String& _cacheFileName, BytecodeHeader _header) {
+		etk::Vector<char> bytecode;
+		#if LUA_VERSION_NUM >= 503
+			int ret = lua_dump(_luaState, bytecodeWriter, &bytecode, int(_header.m_strip));
+		#else
+			int ret = lua_dump(_luaState, bytecodeWriter, &bytecode);
+		#endif
+		if (    ret != 0
+		     || bytecode.size() == 0) {
+			LUAW_WARNING("Can not dump the bytecode for '" << _cacheFileName << "'");
+			return;
+		}
+		_header.m_bytecodeSize = bytecode.size();
+		etk::FSNode node(temporaryFileName(_cacheFileName));
+		if (node.fileOpenWrite() == false) {
+			LUAW_WARNING("Can not write the bytecode cache '" << _cacheFileName << "'");
+			return;
+		}
+		bool valid = node.fileWrite(&_header, sizeof(BytecodeHeader), 1) == 1
+		             && node.fileWrite(&bytecode[0], 1, bytecode.size()) == int64_t(bytecode.size());
+		valid = node.fileClose() == true && valid == true;
+		if (    valid == false
+		     || std::rename(node.getFileSystemName().c_str(), etk::FSNode(_cacheFileName).getFileSystemName().c_str()) != 0) {
+			LUAW_WARNING("Can not write the bytecode cache '" << _cacheFileName << "'");
+			node.remove();
+		}
+	}
+}
+
+luaWrapper::Lua::Lua() :
+  Lua(null, null) {
+	
+}
+
+luaWrapper::Lua::Lua(lua_Alloc _allocator, void* _userData) :
+  m_allocator(_allocator),
+  m_allocatorData(_userData),
+  m_memoryUsage(0),
+  m_memoryPeak(0) {
+	m_luaState = lua_newstate(&Lua::allocate, this);
+	if (m_luaState != null) {
+		lua_atpanic(m_luaState, &Lua::panic);
+		luaL_openlibs(m_luaState);
+	}
+}
+
+void* luaWrapper::Lua::allocate(void* _userData, void* _ptr, size_t _oldSize, size_t _newSize) {
+	Lua* self = static_cast<Lua*>(_userData);
+	// When _ptr is NULL, _oldSize is the type of the new object (not a size).
+	size_t oldSize = _ptr == null ? 0 : _oldSize;
+	size_t usage = self->m_memoryUsage.load(std::memory_order_relaxed);
+	if (    _newSize > oldSize
+	     && self->m_memoryLimit != 0
+	     && usage - oldSize + _newSize > self->m_memoryLimit) {
+		// Lua run an emergency full GC and call again the allocator before raising LUA_ERRMEM.
+		return null;
+	}
+	void* out = null;
+	if (self->m_allocator != null) {
+		out = self->m_allocator(self->m_allocatorData, _ptr, _oldSize, _newSize);
+	} else if (_newSize == 0) {
+		free(_ptr);
+	} else {
+		out = realloc(_ptr, _newSize);
+	}
+	if (    out == null
+	     && _newSize != 0) {
+		return null;
+	}
+	usage = usage - oldSize + _newSize;
+	self->m_memoryUsage.store(usage, std::memory_order_relaxed);
+	if (usage > self->m_memoryPeak.load(std::memory_order_relaxed)) {
+		self->m_memoryPeak.store(usage, std::memory_order_relaxed);
+	}
+	if (self->m_profiler != null) {
+		self->m_profiler->record(self->m_context->m_allocationScope, _ptr, oldSize, out, _newSize);
+	}
+	return out;
+}
+
+void luaWrapper::Lua::profilerHook(lua_State* _luaState, lua_Debug* _info) {
+	BindingContext* context = getContext(_luaState);
+	// No push or create is running when a lua function runs: clear a scope
+	// left by a lua error (longjmp).
+	context->m_allocationScope = null;
+	if (context->m_profiler != null) {
+		context->m_profiler->updateLocation(_luaState, _info);
+	}
+}
+
+void luaWrapper::Lua::setAllocationProfiling(bool _enable) {
+	if (_enable == false) {
+		if (m_profiler != null) {
+			lua_sethook(m_luaState, null, 0, 0);
+			m_context->m_profiler = null;
+			m_profiler.reset();
+		}
+		return;
+	}
+	if (m_luaState == null) {
+		return;
+	}
+	initialize(m_luaState);
+	m_context = getContext(m_luaState);
+	m_profiler = ememory::makeShared<luaWrapper::AllocationProfiler>();
+	m_context->m_profiler = m_profiler.get();
+	// The coroutines created after this call inherit the hook.
+	lua_sethook(m_luaState, &Lua::profilerHook, LUA_MASKLINE | LUA_MASKCALL | LUA_MASKRET, 0);
+}
+
+void luaWrapper::Lua::executeFile(const etk::String& _fileName) {
+	etk::String chunkName = "@" + _fileName;
+	BytecodeHeader header;
+	etk::String cacheFileName;
+	if (m_bytecodeCachePath.empty() == false) {
+		memcpy(header.m_magic, g_bytecodeMagic, sizeof(header.m_magic));
+		header.m_luaVersion = LUA_VERSION_NUM;
+		header.m_strip = m_bytecodeStripDebug == true ? 1 : 0;
+		header.m_bytecodeSize = 0;
+		// The debug information contain the chunk name: the files with the
+		// same content share the entry only when it is stripped.
+		header.m_chunkNameHash = 0;
+		if (m_bytecodeStripDebug == false) {
+			header.m_chunkNameHash = hashAdd(g_hashInit, chunkName.c_str(), chunkName.size());
+		}
+		if (hashFile(_fileName, header.m_sourceHash, header.m_sourceSize) == true) {
+			cacheFileName = m_bytecodeCachePath + "/" + toHexa(header.m_sourceHash);
+			if (m_bytecodeStripDebug == false) {
+				cacheFileName += "-" + toHexa(header.m_chunkNameHash);
+			}
+			cacheFileName += "-" + etk::toString(LUA_VERSION_NUM)
+			                 + (m_bytecodeStripDebug == true ? "-s" : "") + ".luac";
+		}
+	}
+	if (    cacheFileName.empty() == true
+	     || loadBytecodeCache(m_luaState, cacheFileName, header, chunkName) == false) {
+		FileReader file(_fileName);
+		if (file.isOpen() == false) {
+			LUAW_ERROR("Can not open the file '" << _fileName << "'");
+			return;
+		}
+		int ret = lua_load(m_luaState, FileReader::reader, &file, chunkName.c_str(), "t");
+		if (ret != LUA_OK) {
+			reportError(m_luaState, ret);
+			return;
+		}
+		// Do not store the chunk if the file changed since it has been hashed.
+		if (    cacheFileName.empty() == false
+		     && file.getHash() == header.m_sourceHash
+		     && file.getSize() == header.m_sourceSize) {
+			storeBytecodeCache(m_luaState, cacheFileName, header);
+		}
+	}
+	int ret = lua_pcall(m_luaState, 0, LUA_MULTRET, 0);
+	if (ret != LUA_OK) {
+		reportError(m_luaState, ret);
+	}
+}
+
+void luaWrapper::Lua::executeBuffer(const char* _data, size_t _size, const char* _chunkName) {
+	int ret = luaL_loadbufferx(m_luaState, _data, _size, _chunkName, "t");
+	if (ret == LUA_OK) {
+		ret = lua_pcall(m_luaState, 0, LUA_MULTRET, 0);
+	}
+	if (ret != LUA_OK) {
+		reportError(m_luaState, ret);
+	}
+}
+
+int luaWrapper::Lua::panic(lua_State* _luaState) {
+	const char* message = lua_tostring(_luaState, -1);
+	LUAW_CRITICAL("PANIC: unprotected error in call to Lua API (" << (message != null ? message : "error object is not a string") << ")");
+	return 0;
+}
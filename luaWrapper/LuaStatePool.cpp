@@ -0,0 +1,139 @@
+/** @file
+ * @author Edouard DUPIN
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/LuaStatePool.hpp>
+#include <luaWrapper/debug.hpp>
+#include <ethread/tools.hpp>
+
+luaWrapper::LuaStatePool::LuaStatePool(size_t _count, etk::Function<void(luaWrapper::Lua&)> _setup) {
+	m_slots.resize(_count);
+	m_free.reserve(_count);
+	for (size_t iii=0; iii<_count; ++iii) {
+		m_slots[iii].m_lua = ememory::makeShared<luaWrapper::Lua>();
+		if (_setup != null) {
+			_setup(*m_slots[iii].m_lua);
+		}
+		// The first states are given first.
+		m_free.pushBack(_count - iii - 1);
+		m_semaphore.post();
+	}
+}
+
+luaWrapper::LuaStatePool::~LuaStatePool() {
+	for (size_t iii=0; iii<m_slots.size(); ++iii) {
+		if (m_slots[iii].m_used == true) {
+			LUAW_ERROR("Destroy a lua state pool with a checked out state (" << iii << ")");
+		}
+	}
+}
+
+size_t luaWrapper::LuaStatePool::popFree() {
+	if (m_free.size() == 0) {
+		ETK_THROW_EXCEPTION(etk::exception::RuntimeError("No free lua state in the pool"));
+	}
+	size_t index = m_free.back();
+	m_free.popBack();
+	m_slots[index].m_used = true;
+	return index;
+}
+
+luaWrapper::LuaStatePool::Checkout luaWrapper::LuaStatePool::checkout() {
+	m_semaphore.wait();
+	ethread::UniqueLock lock(m_mutex);
+	return Checkout(this, popFree());
+}
+
+luaWrapper::LuaStatePool::Checkout luaWrapper::LuaStatePool::tryCheckout(uint64_t _timeOutInUs) {
+	if (m_semaphore.wait(_timeOutInUs) == false) {
+		return Checkout();
+	}
+	ethread::UniqueLock lock(m_mutex);
+	return Checkout(this, popFree());
+}
+
+luaWrapper::LuaStatePool::Checkout luaWrapper::LuaStatePool::checkoutPinned() {
+	uint32_t thread = ethread::getId();
+	{
+		ethread::UniqueLock lock(m_mutex);
+		for (size_t iii=0; iii<m_slots.size(); ++iii) {
+			Slot& slot = m_slots[iii];
+			if (    slot.m_pinned == false
+			     || slot.m_thread != thread) {
+				continue;
+			}
+			if (slot.m_used == true) {
+				ETK_THROW_EXCEPTION(etk::exception::RuntimeError("The lua state pinned to this thread is already checked out"));
+			}
+			slot.m_used = true;
+			return Checkout(this, iii);
+		}
+	}
+	// No state pinned to this thread: pin a free one. The pin is reserved
+	// before waiting: when all the states are pinned, no state can be given
+	// back to the free list and the wait would never end.
+	{
+		ethread::UniqueLock lock(m_mutex);
+		if (m_pinCount >= m_slots.size()) {
+			ETK_THROW_EXCEPTION(etk::exception::RuntimeError("All the lua states of the pool are pinned"));
+		}
+		m_pinCount++;
+	}
+	m_semaphore.wait();
+	ethread::UniqueLock lock(m_mutex);
+	size_t index = popFree();
+	m_slots[index].m_pinned = true;
+	m_slots[index].m_thread = thread;
+	return Checkout(this, index);
+}
+
+void luaWrapper::LuaStatePool::unpin() {
+	uint32_t thread = ethread::getId();
+	bool released = false;
+	{
+		ethread::UniqueLock lock(m_mutex);
+		for (size_t iii=0; iii<m_slots.size(); ++iii) {
+			Slot& slot = m_slots[iii];
+			if (    slot.m_pinned == false
+			     || slot.m_thread != thread) {
+				continue;
+			}
+			slot.m_pinned = false;
+			m_pinCount--;
+			// A used state is given back to the free list by its checkin.
+			if (slot.m_used == false) {
+				m_free.pushBack(iii);
+				released = true;
+			}
+			break;
+		}
+	}
+	if (released == true) {
+		m_semaphore.post();
+	}
+}
+
+size_t luaWrapper::LuaStatePool::pinCount() {
+	ethread::UniqueLock lock(m_mutex);
+	return m_pinCount;
+}
+
+void luaWrapper::LuaStatePool::checkin(size_t _index) {
+	bool released = false;
+	{
+		ethread::UniqueLock lock(m_mutex);
+		Slot& slot = m_slots[_index];
+		// Do not give the values of the previous job to the next one.
+		lua_settop(slot.m_lua->getState(), 0);
+		slot.m_used = false;
+		if (slot.m_pinned == false) {
+			m_free.pushBack(_index);
+			released = true;
+		}
+	}
+	if (released == true) {
+		m_semaphore.post();
+	}
+}
@@ -0,0 +1,173 @@
+/** @file
+ * @author Edouard DUPIN
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <etk/Function.hpp>
+#include <ethread/Mutex.hpp>
+#include <ethread/Semaphore.hpp>
+
+namespace luaWrapper {
+	/**
+	 * Pool of pre-initialised lua states. A luaWrapper::Lua is single-threaded:
+	 * the pool build N states with the same setup (openlibs is done by Lua, the
+	 * setup callback register the elements and load the scripts), and each worker
+	 * thread checkout a state for the time of its job.
+	 *
+	 *   luaWrapper::LuaStatePool pool(4, [](luaWrapper::Lua& _lua) {
+	 *   	luaWrapper::registerElement<Foo>(_lua, "Foo", NULL, Foo_metatable);
+	 *   	_lua.executeFile("DATA:handler.lua");
+	 *   });
+	 *   // in any thread:
+	 *   luaWrapper::LuaStatePool::Checkout lua = pool.checkout();
+	 *   lua->callVoid("onRequest", 42);
+	 *
+	 * A state can also be pinned to a thread (checkoutPinned): the thread always
+	 * get the same state (its globals are kept between the jobs) and no other
+	 * thread can use it until unpin is called. The pin is not released when the
+	 * thread exits: a worker must call unpin before the end of its thread.
+	 *
+	 *   // in a worker thread:
+	 *   while (m_running == true) {
+	 *   	luaWrapper::LuaStatePool::Checkout lua = pool.checkoutPinned();
+	 *   	lua->callVoid("onRequest", 42);
+	 *   }
+	 *   pool.unpin();
+	 */
+	class LuaStatePool {
+		public:
+			/**
+			 * RAII guard on a checked out state: the state is given back to the
+			 * pool when the guard is destroyed (or when checkin is called).
+			 */
+			class Checkout {
+				friend class LuaStatePool;
+				private:
+					LuaStatePool* m_pool = null;
+					size_t m_index = 0;
+					Checkout(LuaStatePool* _pool, size_t _index) :
+					  m_pool(_pool),
+					  m_index(_index) {
+
+					}
+				public:
+					Checkout() = default;
+					Checkout(const Checkout&) = delete;
+					Checkout& operator=(const Checkout&) = delete;
+					Checkout(Checkout&& _obj) :
+					  m_pool(_obj.m_pool),
+					  m_index(_obj.m_index) {
+						_obj.m_pool = null;
+					}
+					Checkout& operator=(Checkout&& _obj) {
+						if (this != &_obj) {
+							checkin();
+							m_pool = _obj.m_pool;
+							m_index = _obj.m_index;
+							_obj.m_pool = null;
+						}
+						return *this;
+					}
+					~Checkout() {
+						checkin();
+					}
+					/**
+					 * Check if the guard hold a state (tryCheckout can return an empty guard).
+					 */
+					bool isValid() const {
+						return m_pool != null;
+					}
+					/**
+					 * Give back the state to the pool before the end of the guard.
+					 */
+					void checkin() {
+						if (m_pool != null) {
+							m_pool->checkin(m_index);
+							m_pool = null;
+						}
+					}
+					luaWrapper::Lua* get() const {
+						if (m_pool == null) {
+							return null;
+						}
+						return m_pool->m_slots[m_index].m_lua.get();
+					}
+					luaWrapper::Lua* operator->() const {
+						return get();
+					}
+					luaWrapper::Lua& operator*() const {
+						return *get();
+					}
+			};
+		private:
+			class Slot {
+				public:
+					ememory::SharedPtr<luaWrapper::Lua> m_lua;
+					bool m_used = false; //!< The state is checked out.
+					bool m_pinned = false; //!< The state is reserved to the thread m_thread.
+					uint32_t m_thread = 0;
+			};
+			ethread::Mutex m_mutex; //!< Protect m_slots and m_free.
+			ethread::Semaphore m_semaphore; //!< Count the states of m_free.
+			etk::Vector<Slot> m_slots; //!< All the states (the vector is never resized after the constructor).
+			etk::Vector<size_t> m_free; //!< Free and not pinned states (used as a stack: the last used state is the hottest).
+			size_t m_pinCount = 0; //!< Number of pinned states, including the pins waiting for a free state.
+		public:
+			/**
+			 * Create the pool and all its states.
+			 * @param[in] _count Number of states.
+			 * @param[in] _setup Function called on each new state (the exceptions are not catched).
+			 */
+			LuaStatePool(size_t _count, etk::Function<void(luaWrapper::Lua&)> _setup);
+			~LuaStatePool();
+			LuaStatePool(const LuaStatePool&) = delete;
+			LuaStatePool& operator=(const LuaStatePool&) = delete;
+			/**
+			 * Get the number of states of the pool.
+			 */
+			size_t size() const {
+				return m_slots.size();
+			}
+			/**
+			 * Get a free state, wait until one is given back if needed.
+			 * @return Guard on the state.
+			 */
+			Checkout checkout();
+			/**
+			 * Get a free state, wait at most _timeOutInUs.
+			 * @param[in] _timeOutInUs Maximum time to wait in micro-seconds.
+			 * @return Guard on the state (not valid in case of time out).
+			 */
+			Checkout tryCheckout(uint64_t _timeOutInUs);
+			/**
+			 * Get the state pinned to the current thread (pin a free one the
+			 * first time, waiting if needed).
+			 * @note A thread can not checkout its pinned state twice at the same time.
+			 * @note Throw an exception instead of waiting when all the states are
+			 * already pinned by other threads (no state would ever be given back).
+			 * @return Guard on the state.
+			 */
+			Checkout checkoutPinned();
+			/**
+			 * Release the pin of the current thread: its state go back to the
+			 * common states (when it is checked in if it is used).
+			 * @note Must be called by the thread before it exits: the pin of an
+			 * exited thread is never released.
+			 */
+			void unpin();
+			/**
+			 * Get the number of states pinned to a thread.
+			 */
+			size_t pinCount();
+		private:
+			/**
+			 * Get a state from the free list (the semaphore has already been taken).
+			 * @note m_mutex must be locked.
+			 */
+			size_t popFree();
+			void checkin(size_t _index);
+	};
+}
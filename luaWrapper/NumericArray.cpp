@@ -0,0 +1,497 @@
+/** @file
+ * @author Edouard DUPIN
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/NumericArray.hpp>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace {
+	/**
+	 * Conversion of a number in a floating point type: saturated to the
+	 * infinities (an out of range conversion is undefined behavior).
+	 */
+	template <typename LUAW_TYPE>
+	LUAW_TYPE saturate(double _value, std::true_type) {
+		if (_value > double(std::numeric_limits<LUAW_TYPE>::max())) {
+			return std::numeric_limits<LUAW_TYPE>::infinity();
+		}
+		if (_value < double(std::numeric_limits<LUAW_TYPE>::lowest())) {
+			return -std::numeric_limits<LUAW_TYPE>::infinity();
+		}
+		return LUAW_TYPE(_value);
+	}
+	/**
+	 * Conversion of a number in an integer type: saturated to the range of the
+	 * type, NaN gives 0.
+	 */
+	template <typename LUAW_TYPE>
+	LUAW_TYPE saturate(double _value, std::false_type) {
+		if (_value != _value) {
+			return 0;
+		}
+		// max() can be rounded up in double (2^63): the comparison include it.
+		if (_value >= double(std::numeric_limits<LUAW_TYPE>::max())) {
+			return std::numeric_limits<LUAW_TYPE>::max();
+		}
+		if (_value <= double(std::numeric_limits<LUAW_TYPE>::lowest())) {
+			return std::numeric_limits<LUAW_TYPE>::lowest();
+		}
+		return LUAW_TYPE(_value);
+	}
+	template <typename LUAW_TYPE>
+	LUAW_TYPE saturate(double _value) {
+		return saturate<LUAW_TYPE>(_value, std::is_floating_point<LUAW_TYPE>());
+	}
+
+	/**
+	 * Lua conversions of each element type. The reductions are accumulated in
+	 * a wider type (double or uint64_t), the factors of an integer array are
+	 * applied in double. The values out of the range of the type are
+	 * saturated, the additions of integers wrap around (as the lua integers).
+	 */
+	template <typename LUAW_TYPE>
+	class NumericType {
+		public:
+			static const bool floating = std::is_floating_point<LUAW_TYPE>::value;
+			typedef typename std::conditional<floating, double, int64_t>::type Accumulator;
+			typedef typename std::conditional<floating, LUAW_TYPE, double>::type Real;
+			//! Type of the additions (a signed integer overflow is undefined behavior, an unsigned one wrap around).
+			typedef typename std::conditional<floating, std::enable_if<true, LUAW_TYPE>, std::make_unsigned<LUAW_TYPE>>::type::type Arithmetic;
+			//! Type of the reductions.
+			typedef typename std::conditional<floating, double, uint64_t>::type Sum;
+			static const char* name();
+			static LUAW_TYPE check(lua_State* _luaState, int _index) {
+				return check(_luaState, _index, std::integral_constant<bool, floating>());
+			}
+			static void push(lua_State* _luaState, Accumulator _value) {
+				if (floating == true) {
+					lua_pushnumber(_luaState, lua_Number(_value));
+				} else {
+					lua_pushinteger(_luaState, lua_Integer(_value));
+				}
+			}
+		private:
+			static LUAW_TYPE check(lua_State* _luaState, int _index, std::true_type) {
+				return saturate<LUAW_TYPE>(luaL_checknumber(_luaState, _index));
+			}
+			static LUAW_TYPE check(lua_State* _luaState, int _index, std::false_type) {
+				lua_Integer value = luaL_checkinteger(_luaState, _index);
+				if (value > lua_Integer(std::numeric_limits<LUAW_TYPE>::max())) {
+					return std::numeric_limits<LUAW_TYPE>::max();
+				}
+				if (value < lua_Integer(std::numeric_limits<LUAW_TYPE>::lowest())) {
+					return std::numeric_limits<LUAW_TYPE>::lowest();
+				}
+				return LUAW_TYPE(value);
+			}
+	};
+	template<> const char* NumericType<float>::name() {
+		return "Float32Array";
+	}
+	template<> const char* NumericType<double>::name() {
+		return "Float64Array";
+	}
+	template<> const char* NumericType<int32_t>::name() {
+		return "Int32Array";
+	}
+	template<> const char* NumericType<int64_t>::name() {
+		return "Int64Array";
+	}
+
+	/**
+	 * Kernels: simple loops on restrict pointers that the compiler vectorizes
+	 * (no intrinsics: the library is built for several architectures). The
+	 * reductions use 4 independent accumulators, the floating point additions
+	 * can not be reordered by the compiler without -ffast-math. The binary
+	 * kernels check a:op(a) before using the restrict pointers.
+	 */
+	template <typename LUAW_TYPE>
+	void kernelAddSelf(LUAW_TYPE* __restrict _out, size_t _size) {
+		typedef typename NumericType<LUAW_TYPE>::Arithmetic Arithmetic;
+		for (size_t iii=0; iii<_size; ++iii) {
+			_out[iii] = LUAW_TYPE(Arithmetic(_out[iii]) + Arithmetic(_out[iii]));
+		}
+	}
+	template <typename LUAW_TYPE>
+	void kernelAdd(LUAW_TYPE* __restrict _out, const LUAW_TYPE* __restrict _in, size_t _size) {
+		typedef typename NumericType<LUAW_TYPE>::Arithmetic Arithmetic;
+		for (size_t iii=0; iii<_size; ++iii) {
+			_out[iii] = LUAW_TYPE(Arithmetic(_out[iii]) + Arithmetic(_in[iii]));
+		}
+	}
+	template <typename LUAW_TYPE>
+	void kernelAddScalar(LUAW_TYPE* __restrict _out, LUAW_TYPE _value, size_t _size) {
+		typedef typename NumericType<LUAW_TYPE>::Arithmetic Arithmetic;
+		for (size_t iii=0; iii<_size; ++iii) {
+			_out[iii] = LUAW_TYPE(Arithmetic(_out[iii]) + Arithmetic(_value));
+		}
+	}
+	template <typename LUAW_TYPE>
+	void kernelScale(LUAW_TYPE* __restrict _out, typename NumericType<LUAW_TYPE>::Real _factor, size_t _size) {
+		typedef typename NumericType<LUAW_TYPE>::Real Real;
+		for (size_t iii=0; iii<_size; ++iii) {
+			_out[iii] = saturate<LUAW_TYPE>(Real(_out[iii]) * _factor);
+		}
+	}
+	template <typename LUAW_TYPE>
+	void kernelClamp(LUAW_TYPE* __restrict _out, LUAW_TYPE _min, LUAW_TYPE _max, size_t _size) {
+		for (size_t iii=0; iii<_size; ++iii) {
+			LUAW_TYPE value = _out[iii] < _min ? _min : _out[iii];
+			_out[iii] = value > _max ? _max : value;
+		}
+	}
+	template <typename LUAW_TYPE>
+	void kernelLerp(LUAW_TYPE* __restrict _out, const LUAW_TYPE* __restrict _in, typename NumericType<LUAW_TYPE>::Real _factor, size_t _size) {
+		typedef typename NumericType<LUAW_TYPE>::Real Real;
+		for (size_t iii=0; iii<_size; ++iii) {
+			_out[iii] = saturate<LUAW_TYPE>(Real(_out[iii]) + (Real(_in[iii]) - Real(_out[iii])) * _factor);
+		}
+	}
+	template <typename LUAW_TYPE>
+	typename NumericType<LUAW_TYPE>::Accumulator kernelDot(const LUAW_TYPE* __restrict _left, const LUAW_TYPE* __restrict _right, size_t _size) {
+		typedef typename NumericType<LUAW_TYPE>::Sum Sum;
+		Sum sum[4] = {0, 0, 0, 0};
+		size_t iii = 0;
+		for (; iii+4<=_size; iii+=4) {
+			sum[0] += Sum(_left[iii]) * Sum(_right[iii]);
+			sum[1] += Sum(_left[iii+1]) * Sum(_right[iii+1]);
+			sum[2] += Sum(_left[iii+2]) * Sum(_right[iii+2]);
+			sum[3] += Sum(_left[iii+3]) * Sum(_right[iii+3]);
+		}
+		for (; iii<_size; ++iii) {
+			sum[0] += Sum(_left[iii]) * Sum(_right[iii]);
+		}
+		return typename NumericType<LUAW_TYPE>::Accumulator((sum[0] + sum[1]) + (sum[2] + sum[3]));
+	}
+	template <typename LUAW_TYPE>
+	typename NumericType<LUAW_TYPE>::Accumulator kernelSum(const LUAW_TYPE* __restrict _in, size_t _size) {
+		typedef typename NumericType<LUAW_TYPE>::Sum Sum;
+		Sum sum[4] = {0, 0, 0, 0};
+		size_t iii = 0;
+		for (; iii+4<=_size; iii+=4) {
+			sum[0] += Sum(_in[iii]);
+			sum[1] += Sum(_in[iii+1]);
+			sum[2] += Sum(_in[iii+2]);
+			sum[3] += Sum(_in[iii+3]);
+		}
+		for (; iii<_size; ++iii) {
+			sum[0] += Sum(_in[iii]);
+		}
+		return typename NumericType<LUAW_TYPE>::Accumulator((sum[0] + sum[1]) + (sum[2] + sum[3]));
+	}
+	template <typename LUAW_TYPE>
+	LUAW_TYPE kernelMin(const LUAW_TYPE* __restrict _in, size_t _size) {
+		LUAW_TYPE out = _in[0];
+		for (size_t iii=1; iii<_size; ++iii) {
+			out = _in[iii] < out ? _in[iii] : out;
+		}
+		return out;
+	}
+	template <typename LUAW_TYPE>
+	LUAW_TYPE kernelMax(const LUAW_TYPE* __restrict _in, size_t _size) {
+		LUAW_TYPE out = _in[0];
+		for (size_t iii=1; iii<_size; ++iii) {
+			out = _in[iii] > out ? _in[iii] : out;
+		}
+		return out;
+	}
+
+	/**
+	 * The address of this variable is the registry key of the metatable of the arrays of LUAW_TYPE.
+	 */
+	template <typename LUAW_TYPE>
+	const void* numericArrayKey() {
+		static const char g_key = 0;
+		return &g_key;
+	}
+
+	/**
+	 * Get the second array of a binary operation (same type and size).
+	 */
+	template <typename LUAW_TYPE>
+	luaWrapper::NumericArray<LUAW_TYPE>& checkOther(lua_State* _luaState, luaWrapper::NumericArray<LUAW_TYPE>& _array, int _index) {
+		luaWrapper::NumericArray<LUAW_TYPE>& other = luaWrapper::checkNumericArray<LUAW_TYPE>(_luaState, _index);
+		if (other.m_size != _array.m_size) {
+			luaL_error(_luaState, "%s size mismatch (%d and %d)", NumericType<LUAW_TYPE>::name(), int(_array.m_size), int(other.m_size));
+		}
+		return other;
+	}
+
+	/**
+	 * Maximum number of elements of an array (the size of the userdata block does not overflow).
+	 */
+	template <typename LUAW_TYPE>
+	size_t maxSize() {
+		return (SIZE_MAX - sizeof(luaWrapper::NumericArray<LUAW_TYPE>) - luaWrapper::NumericArray<LUAW_TYPE>::alignment) / sizeof(LUAW_TYPE);
+	}
+
+	/**
+	 * The metamethods are reachable from the scripts (array.__index): all of
+	 * them check the type of the array.
+	 */
+	template <typename LUAW_TYPE>
+	int arrayIndex(lua_State* _luaState) {
+		// array key
+		luaWrapper::NumericArray<LUAW_TYPE>* array = &luaWrapper::checkNumericArray<LUAW_TYPE>(_luaState, 1);
+		int isInteger = 0;
+		lua_Integer index = lua_tointegerx(_luaState, 2, &isInteger);
+		if (isInteger != 0) {
+			if (    index < 1
+			     || size_t(index) > array->m_size) {
+				lua_pushnil(_luaState); // array key nil
+				return 1;
+			}
+			NumericType<LUAW_TYPE>::push(_luaState, array->m_data[index - 1]); // array key value
+			return 1;
+		}
+		// Methods
+		lua_getmetatable(_luaState, 1); // array key mt
+		lua_pushvalue(_luaState, 2); // array key mt key
+		lua_rawget(_luaState, -2); // array key mt mt[key]
+		return 1;
+	}
+
+	template <typename LUAW_TYPE>
+	int arrayNewindex(lua_State* _luaState) {
+		// array key value
+		luaWrapper::NumericArray<LUAW_TYPE>* array = &luaWrapper::checkNumericArray<LUAW_TYPE>(_luaState, 1);
+		lua_Integer index = luaL_checkinteger(_luaState, 2);
+		if (    index < 1
+		     || size_t(index) > array->m_size) {
+			return luaL_error(_luaState, "%s index %d out of range [1..%d]", NumericType<LUAW_TYPE>::name(), int(index), int(array->m_size));
+		}
+		array->m_data[index - 1] = NumericType<LUAW_TYPE>::check(_luaState, 3);
+		return 0;
+	}
+
+	template <typename LUAW_TYPE>
+	int arrayLen(lua_State* _luaState) {
+		luaWrapper::NumericArray<LUAW_TYPE>& array = luaWrapper::checkNumericArray<LUAW_TYPE>(_luaState, 1);
+		lua_pushinteger(_luaState, lua_Integer(array.m_size));
+		return 1;
+	}
+
+	template <typename LUAW_TYPE>
+	int arrayAdd(lua_State* _luaState) {
+		// array value|other
+		luaWrapper::NumericArray<LUAW_TYPE>& array = luaWrapper::checkNumericArray<LUAW_TYPE>(_luaState, 1);
+		if (lua_isnumber(_luaState, 2) != 0) {
+			kernelAddScalar<LUAW_TYPE>(array.m_data, NumericType<LUAW_TYPE>::check(_luaState, 2), array.m_size);
+		} else {
+			luaWrapper::NumericArray<LUAW_TYPE>& other = checkOther<LUAW_TYPE>(_luaState, array, 2);
+			if (other.m_data == array.m_data) {
+				kernelAddSelf<LUAW_TYPE>(array.m_data, array.m_size);
+			} else {
+				kernelAdd<LUAW_TYPE>(array.m_data, other.m_data, array.m_size);
+			}
+		}
+		lua_settop(_luaState, 1); // array
+		return 1;
+	}
+
+	template <typename LUAW_TYPE>
+	int arrayScale(lua_State* _luaState) {
+		// array factor
+		luaWrapper::NumericArray<LUAW_TYPE>& array = luaWrapper::checkNumericArray<LUAW_TYPE>(_luaState, 1);
+		kernelScale<LUAW_TYPE>(array.m_data, saturate<typename NumericType<LUAW_TYPE>::Real>(luaL_checknumber(_luaState, 2)), array.m_size);
+		lua_settop(_luaState, 1); // array
+		return 1;
+	}
+
+	template <typename LUAW_TYPE>
+	int arrayClamp(lua_State* _luaState) {
+		// array min max
+		luaWrapper::NumericArray<LUAW_TYPE>& array = luaWrapper::checkNumericArray<LUAW_TYPE>(_luaState, 1);
+		kernelClamp<LUAW_TYPE>(array.m_data, NumericType<LUAW_TYPE>::check(_luaState, 2), NumericType<LUAW_TYPE>::check(_luaState, 3), array.m_size);
+		lua_settop(_luaState, 1); // array
+		return 1;
+	}
+
+	template <typename LUAW_TYPE>
+	int arrayLerp(lua_State* _luaState) {
+		// array other factor
+		luaWrapper::NumericArray<LUAW_TYPE>& array = luaWrapper::checkNumericArray<LUAW_TYPE>(_luaState, 1);
+		luaWrapper::NumericArray<LUAW_TYPE>& other = checkOther<LUAW_TYPE>(_luaState, array, 2);
+		typename NumericType<LUAW_TYPE>::Real factor = saturate<typename NumericType<LUAW_TYPE>::Real>(luaL_checknumber(_luaState, 3));
+		// a:lerp(a, t) does not change a.
+		if (other.m_data != array.m_data) {
+			kernelLerp<LUAW_TYPE>(array.m_data, other.m_data, factor, array.m_size);
+		}
+		lua_settop(_luaState, 1); // array
+		return 1;
+	}
+
+	template <typename LUAW_TYPE>
+	int arrayDot(lua_State* _luaState) {
+		// array other
+		luaWrapper::NumericArray<LUAW_TYPE>& array = luaWrapper::checkNumericArray<LUAW_TYPE>(_luaState, 1);
+		luaWrapper::NumericArray<LUAW_TYPE>& other = checkOther<LUAW_TYPE>(_luaState, array, 2);
+		NumericType<LUAW_TYPE>::push(_luaState, kernelDot<LUAW_TYPE>(array.m_data, other.m_data, array.m_size));
+		return 1;
+	}
+
+	template <typename LUAW_TYPE>
+	int arraySum(lua_State* _luaState) {
+		luaWrapper::NumericArray<LUAW_TYPE>& array = luaWrapper::checkNumericArray<LUAW_TYPE>(_luaState, 1);
+		NumericType<LUAW_TYPE>::push(_luaState, kernelSum<LUAW_TYPE>(array.m_data, array.m_size));
+		return 1;
+	}
+
+	template <typename LUAW_TYPE>
+	int arrayMin(lua_State* _luaState) {
+		luaWrapper::NumericArray<LUAW_TYPE>& array = luaWrapper::checkNumericArray<LUAW_TYPE>(_luaState, 1);
+		if (array.m_size == 0) {
+			lua_pushnil(_luaState);
+			return 1;
+		}
+		NumericType<LUAW_TYPE>::push(_luaState, kernelMin<LUAW_TYPE>(array.m_data, array.m_size));
+		return 1;
+	}
+
+	template <typename LUAW_TYPE>
+	int arrayMax(lua_State* _luaState) {
+		luaWrapper::NumericArray<LUAW_TYPE>& array = luaWrapper::checkNumericArray<LUAW_TYPE>(_luaState, 1);
+		if (array.m_size == 0) {
+			lua_pushnil(_luaState);
+			return 1;
+		}
+		NumericType<LUAW_TYPE>::push(_luaState, kernelMax<LUAW_TYPE>(array.m_data, array.m_size));
+		return 1;
+	}
+
+	/**
+	 * XxxArray.new(size) or XxxArray.new({values...})
+	 */
+	template <typename LUAW_TYPE>
+	int arrayNew(lua_State* _luaState) {
+		if (lua_type(_luaState, 1) != LUA_TTABLE) {
+			lua_Integer size = luaL_checkinteger(_luaState, 1);
+			luaL_argcheck(_luaState, size >= 0, 1, "negative size");
+			luaL_argcheck(_luaState, uint64_t(size) <= uint64_t(maxSize<LUAW_TYPE>()), 1, "size too big");
+			luaWrapper::newNumericArray<LUAW_TYPE>(_luaState, size_t(size)); // size array
+			return 1;
+		}
+		size_t size = lua_rawlen(_luaState, 1);
+		luaWrapper::NumericArray<LUAW_TYPE>* array = luaWrapper::newNumericArray<LUAW_TYPE>(_luaState, size); // {} array
+		for (size_t iii=0; iii<size; ++iii) {
+			lua_rawgeti(_luaState, 1, lua_Integer(iii + 1)); // {} array value
+			array->m_data[iii] = NumericType<LUAW_TYPE>::check(_luaState, -1);
+			lua_pop(_luaState, 1); // {} array
+		}
+		return 1;
+	}
+
+	/**
+	 * Push the metatable of the arrays of LUAW_TYPE (created on the first use in the state).
+	 */
+	template <typename LUAW_TYPE>
+	void pushMetatable(lua_State* _luaState) {
+		if (lua_rawgetp(_luaState, LUA_REGISTRYINDEX, numericArrayKey<LUAW_TYPE>()) == LUA_TTABLE) {
+			// ... mt
+			return;
+		}
+		lua_pop(_luaState, 1); // ...
+		const luaL_Reg metatable[] = {
+			{ "__index", arrayIndex<LUAW_TYPE> },
+			{ "__newindex", arrayNewindex<LUAW_TYPE> },
+			{ "__len", arrayLen<LUAW_TYPE> },
+			{ "add", arrayAdd<LUAW_TYPE> },
+			{ "scale", arrayScale<LUAW_TYPE> },
+			{ "clamp", arrayClamp<LUAW_TYPE> },
+			{ "lerp", arrayLerp<LUAW_TYPE> },
+			{ "dot", arrayDot<LUAW_TYPE> },
+			{ "sum", arraySum<LUAW_TYPE> },
+			{ "min", arrayMin<LUAW_TYPE> },
+			{ "max", arrayMax<LUAW_TYPE> },
+			{ NULL, NULL }
+		};
+		lua_createtable(_luaState, 0, 12); // ... mt
+		luaL_setfuncs(_luaState, metatable, 0); // ... mt
+		lua_pushstring(_luaState, NumericType<LUAW_TYPE>::name()); // ... mt name
+		lua_setfield(_luaState, -2, "__name"); // ... mt
+		lua_pushvalue(_luaState, -1); // ... mt mt
+		lua_rawsetp(_luaState, LUA_REGISTRYINDEX, numericArrayKey<LUAW_TYPE>()); // ... mt
+	}
+
+	template <typename LUAW_TYPE>
+	void registerArray(lua_State* _luaState) {
+		lua_createtable(_luaState, 0, 1); // {}
+		lua_pushcfunction(_luaState, arrayNew<LUAW_TYPE>); // {} new
+		lua_setfield(_luaState, -2, "new"); // {}
+		lua_setglobal(_luaState, NumericType<LUAW_TYPE>::name()); // ...
+	}
+}
+
+template <typename LUAW_TYPE>
+luaWrapper::NumericArray<LUAW_TYPE>* luaWrapper::newNumericArray(lua_State* _luaState, size_t _size) {
+	const size_t alignment = NumericArray<LUAW_TYPE>::alignment;
+	if (_size > maxSize<LUAW_TYPE>()) {
+		luaL_error(_luaState, "%s size too big (%d elements)", NumericType<LUAW_TYPE>::name(), int(_size));
+	}
+	char* block = static_cast<char*>(lua_newuserdata(_luaState, sizeof(NumericArray<LUAW_TYPE>) + _size * sizeof(LUAW_TYPE) + alignment - 1)); // ... array
+	NumericArray<LUAW_TYPE>* array = reinterpret_cast<NumericArray<LUAW_TYPE>*>(block);
+	uintptr_t data = reinterpret_cast<uintptr_t>(block + sizeof(NumericArray<LUAW_TYPE>));
+	data = (data + alignment - 1) & ~uintptr_t(alignment - 1);
+	array->m_size = _size;
+	array->m_data = reinterpret_cast<LUAW_TYPE*>(data);
+	memset(array->m_data, 0, _size * sizeof(LUAW_TYPE));
+	pushMetatable<LUAW_TYPE>(_luaState); // ... array mt
+	lua_setmetatable(_luaState, -2); // ... array
+	return array;
+}
+
+template <typename LUAW_TYPE>
+luaWrapper::NumericArray<LUAW_TYPE>* luaWrapper::pushNumericArray(lua_State* _luaState, const LUAW_TYPE* _data, size_t _size) {
+	NumericArray<LUAW_TYPE>* array = newNumericArray<LUAW_TYPE>(_luaState, _size); // ... array
+	if (_size != 0) {
+		memcpy(array->m_data, _data, _size * sizeof(LUAW_TYPE));
+	}
+	return array;
+}
+
+template <typename LUAW_TYPE>
+luaWrapper::NumericArray<LUAW_TYPE>* luaWrapper::toNumericArray(lua_State* _luaState, int _index) {
+	void* data = lua_touserdata(_luaState, _index);
+	if (    data == null
+	     || lua_getmetatable(_luaState, _index) == 0) {
+		return null;
+	}
+	// ... mt
+	lua_rawgetp(_luaState, LUA_REGISTRYINDEX, numericArrayKey<LUAW_TYPE>()); // ... mt arraymt
+	bool equal = lua_rawequal(_luaState, -1, -2) != 0;
+	lua_pop(_luaState, 2); // ...
+	return equal == true ? static_cast<NumericArray<LUAW_TYPE>*>(data) : null;
+}
+
+template <typename LUAW_TYPE>
+luaWrapper::NumericArray<LUAW_TYPE>& luaWrapper::checkNumericArray(lua_State* _luaState, int _index) {
+	NumericArray<LUAW_TYPE>* array = toNumericArray<LUAW_TYPE>(_luaState, _index);
+	if (array == null) {
+		const char *msg = lua_pushfstring(_luaState, "%s expected, got %s", NumericType<LUAW_TYPE>::name(), luaL_typename(_luaState, _index));
+		luaL_argerror(_luaState, _index, msg);
+	}
+	return *array;
+}
+
+void luaWrapper::registerNumericArrays(luaWrapper::Lua& _lua) {
+	registerArray<float>(_lua.getState());
+	registerArray<double>(_lua.getState());
+	registerArray<int32_t>(_lua.getState());
+	registerArray<int64_t>(_lua.getState());
+}
+
+#define LUAW_NUMERIC_ARRAY_INSTANCIATE(type) \
+	template luaWrapper::NumericArray<type>* luaWrapper::newNumericArray<type>(lua_State*, size_t); \
+	template luaWrapper::NumericArray<type>* luaWrapper::pushNumericArray<type>(lua_State*, const type*, size_t); \
+	template luaWrapper::NumericArray<type>* luaWrapper::toNumericArray<type>(lua_State*, int); \
+	template luaWrapper::NumericArray<type>& luaWrapper::checkNumericArray<type>(lua_State*, int);
+
+LUAW_NUMERIC_ARRAY_INSTANCIATE(float)
+LUAW_NUMERIC_ARRAY_INSTANCIATE(double)
+LUAW_NUMERIC_ARRAY_INSTANCIATE(int32_t)
+LUAW_NUMERIC_ARRAY_INSTANCIATE(int64_t)
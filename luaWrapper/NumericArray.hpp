@@ -0,0 +1,63 @@
+/** @file
+ * @author Edouard DUPIN
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <luaWrapper/luaWrapper.hpp>
+
+namespace luaWrapper {
+	/**
+	 * Typed array of numbers (float, double, int32_t or int64_t) stored in one
+	 * userdata block (aligned on NumericArray::alignment, counted by the memory
+	 * limit of the state). It avoids the boxed numbers of a lua table, and the
+	 * bulk operations run the loop in C++:
+	 *
+	 *   luaWrapper::registerNumericArrays(lua); // Float32Array, Float64Array, Int32Array, Int64Array
+	 *   luaWrapper::pushNumericArray<float>(L, samples.dataPointer(), samples.size());
+	 *
+	 * Lua:
+	 *   local a = Float32Array.new(1000) -- zero filled (or Float32Array.new({1, 2, 3}))
+	 *   a[1] = 2.5; print(a[1], #a)
+	 *   a:add(b) a:add(1.0) a:scale(0.5) a:clamp(0, 1) a:lerp(b, 0.25) -- in place
+	 *   a:dot(b) a:sum() a:min() a:max() -- reductions
+	 *
+	 * The index is checked (nil out of the array, error when setting out of it).
+	 * The operations between two arrays need the same type and size. The
+	 * values out of the range of the type are saturated (NaN is 0 in an
+	 * integer array), the integer additions wrap around as the lua integers.
+	 */
+	template <typename LUAW_TYPE>
+	class NumericArray {
+		public:
+			static const size_t alignment = 32; //!< alignment of m_data (AVX registers)
+			size_t m_size; //!< number of elements
+			LUAW_TYPE* m_data; //!< elements (in the same userdata block)
+	};
+	/**
+	 * Push a new zero filled array.
+	 */
+	template <typename LUAW_TYPE>
+	NumericArray<LUAW_TYPE>* newNumericArray(lua_State* _luaState, size_t _size);
+	/**
+	 * Push a new array with a copy of the data.
+	 */
+	template <typename LUAW_TYPE>
+	NumericArray<LUAW_TYPE>* pushNumericArray(lua_State* _luaState, const LUAW_TYPE* _data, size_t _size);
+	/**
+	 * Get the array at the given index, or NULL if the value is not an array of LUAW_TYPE.
+	 */
+	template <typename LUAW_TYPE>
+	NumericArray<LUAW_TYPE>* toNumericArray(lua_State* _luaState, int _index);
+	/**
+	 * Get the array at the given index (raise an error if the value is not an array of LUAW_TYPE).
+	 */
+	template <typename LUAW_TYPE>
+	NumericArray<LUAW_TYPE>& checkNumericArray(lua_State* _luaState, int _index);
+	/**
+	 * Set the global tables Float32Array, Float64Array, Int32Array and Int64Array
+	 * (with the "new" function).
+	 */
+	void registerNumericArrays(Lua& _lua);
+}
@@ -0,0 +1,215 @@
+/** @file
+ * @author Edouard DUPIN
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/PoolAllocator.hpp>
+#include <ethread/Mutex.hpp>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+	const size_t g_classStep = 16;
+	const size_t g_classCount = luaWrapper::PoolAllocator::maxPoolSize / g_classStep;
+	const size_t g_chunkSize = 64*1024; //!< Size of the memory taken from malloc to fill a pool.
+	const size_t g_maxCachedSize = 4*g_chunkSize; //!< Above this size of free blocks, a thread give back a list to the depot.
+
+	struct FreeBlock {
+		FreeBlock* m_next;
+	};
+
+	inline size_t sizeClass(size_t _size) {
+		return (_size - 1) / g_classStep;
+	}
+
+	/**
+	 * List of free blocks of one size class.
+	 */
+	class FreeList {
+		public:
+			FreeBlock* m_first = null;
+			FreeBlock* m_last = null;
+			size_t m_count = 0;
+			void push(void* _ptr) {
+				FreeBlock* block = static_cast<FreeBlock*>(_ptr);
+				block->m_next = m_first;
+				m_first = block;
+				if (m_last == null) {
+					m_last = block;
+				}
+				++m_count;
+			}
+			void* pop() {
+				FreeBlock* block = m_first;
+				m_first = block->m_next;
+				if (m_first == null) {
+					m_last = null;
+				}
+				--m_count;
+				return block;
+			}
+			void splice(FreeList& _list) {
+				if (_list.m_first == null) {
+					return;
+				}
+				_list.m_last->m_next = m_first;
+				if (m_last == null) {
+					m_last = _list.m_last;
+				}
+				m_first = _list.m_first;
+				m_count += _list.m_count;
+				_list = FreeList();
+			}
+	};
+
+	/**
+	 * Free blocks given back by the threads (protected by depotMutex).
+	 */
+	ethread::Mutex& depotMutex() {
+		static ethread::Mutex g_mutex;
+		return g_mutex;
+	}
+	FreeList g_depot[g_classCount];
+
+	/**
+	 * Free blocks of the current thread: no lock on the hot path.
+	 */
+	class ThreadCache {
+		private:
+			FreeList m_free[g_classCount];
+		public:
+			~ThreadCache() {
+				ethread::UniqueLock lock(depotMutex());
+				for (size_t iii=0; iii<g_classCount; ++iii) {
+					g_depot[iii].splice(m_free[iii]);
+				}
+			}
+			void* allocate(size_t _class) {
+				if (    m_free[_class].m_count == 0
+				     && refill(_class) == false) {
+					return null;
+				}
+				return m_free[_class].pop();
+			}
+			void release(void* _ptr, size_t _class) {
+				m_free[_class].push(_ptr);
+				if (m_free[_class].m_count * (_class + 1) * g_classStep > g_maxCachedSize) {
+					ethread::UniqueLock lock(depotMutex());
+					g_depot[_class].splice(m_free[_class]);
+				}
+			}
+		private:
+			bool refill(size_t _class) {
+				{
+					ethread::UniqueLock lock(depotMutex());
+					m_free[_class].splice(g_depot[_class]);
+				}
+				if (m_free[_class].m_count != 0) {
+					return true;
+				}
+				char* chunk = static_cast<char*>(malloc(g_chunkSize));
+				if (chunk == null) {
+					return false;
+				}
+				size_t blockSize = (_class + 1) * g_classStep;
+				for (size_t offset=0; offset + blockSize <= g_chunkSize; offset += blockSize) {
+					m_free[_class].push(chunk + offset);
+				}
+				return true;
+			}
+	};
+	thread_local ThreadCache g_threadCache;
+}
+
+void* luaWrapper::PoolAllocator::allocate(void* _userData, void* _ptr, size_t _oldSize, size_t _newSize) {
+	PoolAllocator* allocator = static_cast<PoolAllocator*>(_userData);
+	// When _ptr is NULL, _oldSize is the type of the new object (not a size).
+	return allocator->reallocate(_ptr, _ptr == null ? 0 : _oldSize, _newSize);
+}
+
+void* luaWrapper::PoolAllocator::reallocate(void* _ptr, size_t _oldSize, size_t _newSize) {
+	if (_newSize == 0) {
+		if (_ptr != null) {
+			release(_ptr, _oldSize);
+			m_free.fetch_add(1, std::memory_order_relaxed);
+			updateSize(_oldSize, 0);
+		}
+		return null;
+	}
+	void* out = null;
+	if (    _ptr != null
+	     && _oldSize <= maxPoolSize
+	     && _newSize <= maxPoolSize
+	     && sizeClass(_oldSize) == sizeClass(_newSize)) {
+		// The block is big enough.
+		out = _ptr;
+	} else if (    _ptr != null
+	            && _oldSize > maxPoolSize
+	            && _newSize > maxPoolSize) {
+		out = realloc(_ptr, _newSize);
+		if (    out != null
+		     && _newSize > _oldSize) {
+			m_systemAllocation.fetch_add(1, std::memory_order_relaxed);
+		}
+	} else {
+		out = get(_newSize);
+		if (    out != null
+		     && _ptr != null) {
+			memcpy(out, _ptr, _oldSize < _newSize ? _oldSize : _newSize);
+			release(_ptr, _oldSize);
+			m_free.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	if (    out == null
+	     && _ptr != null
+	     && _newSize <= _oldSize) {
+		// Lua expects a shrink to never fail: keep the block. It is bigger
+		// than _newSize, release() of this size (later) stays valid: a
+		// block of malloc or of a bigger class is usable in the pool of a
+		// smaller class.
+		out = _ptr;
+	}
+	if (out == null) {
+		m_failure.fetch_add(1, std::memory_order_relaxed);
+		return null;
+	}
+	updateSize(_oldSize, _newSize);
+	return out;
+}
+
+void luaWrapper::PoolAllocator::updateSize(size_t _oldSize, size_t _newSize) {
+	size_t current = m_currentSize.fetch_add(_newSize - _oldSize, std::memory_order_relaxed) + (_newSize - _oldSize);
+	size_t peak = m_peakSize.load(std::memory_order_relaxed);
+	while (    current > peak
+	        && m_peakSize.compare_exchange_weak(peak, current, std::memory_order_relaxed) == false) {
+		// peak has been reloaded
+	}
+}
+
+void* luaWrapper::PoolAllocator::get(size_t _size) {
+	void* out = null;
+	if (_size <= maxPoolSize) {
+		out = g_threadCache.allocate(sizeClass(_size));
+		if (out != null) {
+			m_poolAllocation.fetch_add(1, std::memory_order_relaxed);
+		}
+	} else {
+		out = malloc(_size);
+		if (out != null) {
+			m_systemAllocation.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	if (out != null) {
+		m_allocation.fetch_add(1, std::memory_order_relaxed);
+	}
+	return out;
+}
+
+void luaWrapper::PoolAllocator::release(void* _ptr, size_t _size) {
+	if (_size <= maxPoolSize) {
+		g_threadCache.release(_ptr, sizeClass(_size));
+		return;
+	}
+	free(_ptr);
+}
@@ -0,0 +1,102 @@
+/** @file
+ * @author Edouard DUPIN
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <lua/lua.h>
+#include <atomic>
+
+namespace luaWrapper {
+	/**
+	 * lua_Alloc with size-class pools for the small blocks (tables, strings,
+	 * closures, Userdata...). The free blocks are cached per thread: the
+	 * states running in different threads do not contend on the system malloc.
+	 *
+	 *   luaWrapper::PoolAllocator allocator;
+	 *   luaWrapper::Lua lua(luaWrapper::PoolAllocator::allocate, &allocator);
+	 *
+	 * The allocator must live longer than the state. A state can move from a
+	 * thread to another (LuaStatePool): a block freed in another thread go in
+	 * the cache of this thread. The cache of a thread that exit is given back
+	 * to a global depot used by the other threads. The memory of the pools is
+	 * kept for the life of the process (like a malloc arena).
+	 */
+	class PoolAllocator {
+		public:
+			static const size_t maxPoolSize = 256; //!< Bigger blocks are allocated with malloc.
+			/**
+			 * Allocation statistics of the states that use this allocator (snapshot).
+			 */
+			class Statistic {
+				public:
+					uint64_t m_allocation = 0; //!< Number of new blocks (allocation or move of a block in a bigger class).
+					uint64_t m_free = 0; //!< Number of released blocks.
+					uint64_t m_poolAllocation = 0; //!< Blocks given by the size-class pools.
+					uint64_t m_systemAllocation = 0; //!< Blocks given by malloc/realloc (bigger than maxPoolSize).
+					uint64_t m_failure = 0; //!< Allocations that returned NULL.
+					size_t m_currentSize = 0; //!< Bytes currently used by lua.
+					size_t m_peakSize = 0; //!< Maximum of m_currentSize.
+			};
+		private:
+			//! Counters of Statistic: the states that share the allocator can run in
+			//! different threads (relaxed atomics: they are only statistics).
+			std::atomic<uint64_t> m_allocation;
+			std::atomic<uint64_t> m_free;
+			std::atomic<uint64_t> m_poolAllocation;
+			std::atomic<uint64_t> m_systemAllocation;
+			std::atomic<uint64_t> m_failure;
+			std::atomic<size_t> m_currentSize;
+			std::atomic<size_t> m_peakSize;
+		public:
+			PoolAllocator() :
+			  m_allocation(0),
+			  m_free(0),
+			  m_poolAllocation(0),
+			  m_systemAllocation(0),
+			  m_failure(0),
+			  m_currentSize(0),
+			  m_peakSize(0) {
+				
+			}
+			PoolAllocator(const PoolAllocator&) = delete;
+			PoolAllocator& operator=(const PoolAllocator&) = delete;
+			/**
+			 * The lua_Alloc function (_userData is the PoolAllocator).
+			 */
+			static void* allocate(void* _userData, void* _ptr, size_t _oldSize, size_t _newSize);
+			/**
+			 * Get a snapshot of the statistics (the counters are read one by one:
+			 * they can be updated by the other threads during the read).
+			 */
+			Statistic getStatistic() const {
+				Statistic out;
+				out.m_allocation = m_allocation.load(std::memory_order_relaxed);
+				out.m_free = m_free.load(std::memory_order_relaxed);
+				out.m_poolAllocation = m_poolAllocation.load(std::memory_order_relaxed);
+				out.m_systemAllocation = m_systemAllocation.load(std::memory_order_relaxed);
+				out.m_failure = m_failure.load(std::memory_order_relaxed);
+				out.m_currentSize = m_currentSize.load(std::memory_order_relaxed);
+				out.m_peakSize = m_peakSize.load(std::memory_order_relaxed);
+				return out;
+			}
+			/**
+			 * Reset the counters (the current size is kept).
+			 */
+			void resetStatistic() {
+				m_allocation.store(0, std::memory_order_relaxed);
+				m_free.store(0, std::memory_order_relaxed);
+				m_poolAllocation.store(0, std::memory_order_relaxed);
+				m_systemAllocation.store(0, std::memory_order_relaxed);
+				m_failure.store(0, std::memory_order_relaxed);
+				m_peakSize.store(m_currentSize.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			}
+		private:
+			void* reallocate(void* _ptr, size_t _oldSize, size_t _newSize);
+			void* get(size_t _size);
+			void release(void* _ptr, size_t _size);
+			void updateSize(size_t _oldSize, size_t _newSize);
+	};
+}
@@ -0,0 +1,113 @@
+/** @file
+ * @author Edouard DUPIN
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/StructView.hpp>
+
+namespace luaWrapper {
+	template<> StructFieldType structFieldType<float>() {
+		return StructFieldType::typeFloat;
+	}
+	template<> StructFieldType structFieldType<double>() {
+		return StructFieldType::typeDouble;
+	}
+	template<> StructFieldType structFieldType<int8_t>() {
+		return StructFieldType::typeInt8;
+	}
+	template<> StructFieldType structFieldType<int16_t>() {
+		return StructFieldType::typeInt16;
+	}
+	template<> StructFieldType structFieldType<int32_t>() {
+		return StructFieldType::typeInt32;
+	}
+	template<> StructFieldType structFieldType<int64_t>() {
+		return StructFieldType::typeInt64;
+	}
+	template<> StructFieldType structFieldType<uint8_t>() {
+		return StructFieldType::typeUInt8;
+	}
+	template<> StructFieldType structFieldType<uint16_t>() {
+		return StructFieldType::typeUInt16;
+	}
+	template<> StructFieldType structFieldType<uint32_t>() {
+		return StructFieldType::typeUInt32;
+	}
+	template<> StructFieldType structFieldType<bool>() {
+		return StructFieldType::typeBool;
+	}
+}
+
+void luaWrapper::pushStructField(lua_State* _luaState, const luaWrapper::StructField& _field, const void* _record) {
+	const char* data = static_cast<const char*>(_record) + _field.m_offset;
+	switch (_field.m_type) {
+		case StructFieldType::typeFloat:
+			lua_pushnumber(_luaState, *reinterpret_cast<const float*>(data));
+			return;
+		case StructFieldType::typeDouble:
+			lua_pushnumber(_luaState, *reinterpret_cast<const double*>(data));
+			return;
+		case StructFieldType::typeInt8:
+			lua_pushinteger(_luaState, *reinterpret_cast<const int8_t*>(data));
+			return;
+		case StructFieldType::typeInt16:
+			lua_pushinteger(_luaState, *reinterpret_cast<const int16_t*>(data));
+			return;
+		case StructFieldType::typeInt32:
+			lua_pushinteger(_luaState, *reinterpret_cast<const int32_t*>(data));
+			return;
+		case StructFieldType::typeInt64:
+			lua_pushinteger(_luaState, *reinterpret_cast<const int64_t*>(data));
+			return;
+		case StructFieldType::typeUInt8:
+			lua_pushinteger(_luaState, *reinterpret_cast<const uint8_t*>(data));
+			return;
+		case StructFieldType::typeUInt16:
+			lua_pushinteger(_luaState, *reinterpret_cast<const uint16_t*>(data));
+			return;
+		case StructFieldType::typeUInt32:
+			lua_pushinteger(_luaState, *reinterpret_cast<const uint32_t*>(data));
+			return;
+		case StructFieldType::typeBool:
+			lua_pushboolean(_luaState, *reinterpret_cast<const bool*>(data));
+			return;
+	}
+	lua_pushnil(_luaState);
+}
+
+void luaWrapper::setStructField(lua_State* _luaState, const luaWrapper::StructField& _field, void* _record, int _index) {
+	char* data = static_cast<char*>(_record) + _field.m_offset;
+	switch (_field.m_type) {
+		case StructFieldType::typeFloat:
+			*reinterpret_cast<float*>(data) = float(luaL_checknumber(_luaState, _index));
+			return;
+		case StructFieldType::typeDouble:
+			*reinterpret_cast<double*>(data) = double(luaL_checknumber(_luaState, _index));
+			return;
+		case StructFieldType::typeInt8:
+			*reinterpret_cast<int8_t*>(data) = int8_t(luaL_checkinteger(_luaState, _index));
+			return;
+		case StructFieldType::typeInt16:
+			*reinterpret_cast<int16_t*>(data) = int16_t(luaL_checkinteger(_luaState, _index));
+			return;
+		case StructFieldType::typeInt32:
+			*reinterpret_cast<int32_t*>(data) = int32_t(luaL_checkinteger(_luaState, _index));
+			return;
+		case StructFieldType::typeInt64:
+			*reinterpret_cast<int64_t*>(data) = int64_t(luaL_checkinteger(_luaState, _index));
+			return;
+		case StructFieldType::typeUInt8:
+			*reinterpret_cast<uint8_t*>(data) = uint8_t(luaL_checkinteger(_luaState, _index));
+			return;
+		case StructFieldType::typeUInt16:
+			*reinterpret_cast<uint16_t*>(data) = uint16_t(luaL_checkinteger(_luaState, _index));
+			return;
+		case StructFieldType::typeUInt32:
+			*reinterpret_cast<uint32_t*>(data) = uint32_t(luaL_checkinteger(_luaState, _index));
+			return;
+		case StructFieldType::typeBool:
+			*reinterpret_cast<bool*>(data) = lua_toboolean(_luaState, _index) != 0;
+			return;
+	}
+}
@@ -0,0 +1,413 @@
+/** @file
+ * @author Edouard DUPIN
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <cstddef>
+
+namespace luaWrapper {
+	/**
+	 * Scalar types of the fields of a struct view.
+	 */
+	enum class StructFieldType {
+		typeFloat,
+		typeDouble,
+		typeInt8,
+		typeInt16,
+		typeInt32,
+		typeInt64,
+		typeUInt8,
+		typeUInt16,
+		typeUInt32,
+		typeBool
+	};
+	template <typename LUAW_TYPE>
+	StructFieldType structFieldType();
+	/**
+	 * Description of one field of a struct: use LUAW_STRUCT_FIELD.
+	 */
+	class StructField {
+		public:
+			const char* m_name; //!< name in lua (NULL at the end of the list)
+			size_t m_offset; //!< offset in the struct
+			StructFieldType m_type; //!< scalar type
+	};
+	/**
+	 * Push the field of a record.
+	 */
+	void pushStructField(lua_State* _luaState, const StructField& _field, const void* _record);
+	/**
+	 * Set the field of a record with the value at the given index (raise an error if it is not a number).
+	 */
+	void setStructField(lua_State* _luaState, const StructField& _field, void* _record, int _index);
+}
+
+/**
+ * Description of a field of a struct: { "name", offset, type }
+ */
+#define LUAW_STRUCT_FIELD(type, member, name) \
+	{ name, offsetof(type, member), luaWrapper::structFieldType<decltype(type::member)>() }
+
+namespace luaWrapper {
+	/**
+	 * View of an etk::Vector of plain structs (particles, transforms...): the
+	 * struct is described once with its fields, and the script read and write
+	 * them directly in the vector, without any userdata per element:
+	 *
+	 *   static luaWrapper::StructField particleFields[] = {
+	 *     LUAW_STRUCT_FIELD(Particle, m_x, "x"),
+	 *     LUAW_STRUCT_FIELD(Particle, m_speed, "speed"),
+	 *     { NULL, 0, luaWrapper::StructFieldType::typeFloat }
+	 *   };
+	 *   luaWrapper::registerStruct<Particle>(L, particleFields);
+	 *   luaWrapper::pushStructView<Particle>(L, m_particles); // or a const vector: read-only
+	 *
+	 * Lua:
+	 *   for i=1,#particles do
+	 *     local p = particles[i]
+	 *     p.x = p.x + p.speed
+	 *   end
+	 *
+	 * view[i] return the cursor of the view moved on the record i (always the
+	 * same userdata: the loop does not allocate), so the previous value of
+	 * view[j] now see the record i. Two records can not be used in the same
+	 * expression with view[i]: use view:get/view:set (no cursor), or
+	 * view:cursor(i) that create an independent cursor:
+	 *
+	 *   particles[1].x = particles[2].x -- WRONG: write the record 2 (the
+	 *                                   -- cursor moved on 2 before the write)
+	 *   particles:set(1, "x", particles:get(2, "x")) -- OK
+	 *   local first = particles:cursor(1)
+	 *   first.x = particles[2].x -- OK
+	 *
+	 * As VectorView, the view does not own the vector (see the generation counter
+	 * of pushBorrowed). The index of a cursor is checked at each access (the
+	 * vector can be resized).
+	 */
+	template <typename LUAW_TYPE>
+	class StructView {
+		public:
+			etk::Vector<LUAW_TYPE>* m_vector; //!< the viewed vector
+			bool m_readOnly; //!< the fields can not be set (the vector was given const)
+			const uint32_t* m_generationCounter; //!< generation counter of the vector (or NULL)
+			uint32_t m_generation; //!< value of *m_generationCounter when the view has been pushed
+			/**
+			 * Get the vector (raise a lua error if it has been destroyed).
+			 */
+			etk::Vector<LUAW_TYPE>& get(lua_State* _luaState) {
+				if (    m_generationCounter != null
+				     && *m_generationCounter != m_generation) {
+					luaL_error(_luaState, "the vector of the view has been destroyed");
+				}
+				return *m_vector;
+			}
+			/**
+			 * Get a record (raise a lua error if the vector has been destroyed or if the index is out of range).
+			 */
+			LUAW_TYPE* record(lua_State* _luaState, size_t _index) {
+				etk::Vector<LUAW_TYPE>& vector = get(_luaState);
+				if (_index >= vector.size()) {
+					luaL_error(_luaState, "struct view index %d out of range [1..%d]", int(_index + 1), int(vector.size()));
+				}
+				return &vector[_index];
+			}
+	};
+	/**
+	 * Position of a cursor in a StructView (the cursor keep the view alive with its user value).
+	 */
+	template <typename LUAW_TYPE>
+	class StructCursor {
+		public:
+			StructView<LUAW_TYPE>* m_view; //!< viewed vector
+			size_t m_index; //!< index of the record (from 0)
+	};
+
+	/**
+	 * The address of this variable is the registry key of the metatable of the
+	 * views of etk::Vector<T>.
+	 */
+	template <typename LUAW_TYPE>
+	inline const void* structViewKey() {
+		static const char g_key = 0;
+		return &g_key;
+	}
+	/**
+	 * The address of this variable is the registry key of the metatable of the
+	 * cursors of T.
+	 */
+	template <typename LUAW_TYPE>
+	inline const void* structCursorKey() {
+		static const char g_key = 0;
+		return &g_key;
+	}
+
+	/**
+	 * Get the userdata at the given index if its metatable is the one at the
+	 * registry key _key (NULL otherwise).
+	 *
+	 * This function is only called from LuaWrapper internally.
+	 */
+	inline void* toStructUserdata(lua_State* _luaState, int _index, const void* _key) {
+		void* data = lua_touserdata(_luaState, _index);
+		if (    data == null
+		     || lua_getmetatable(_luaState, _index) == 0) {
+			return null;
+		}
+		// ... mt
+		lua_rawgetp(_luaState, LUA_REGISTRYINDEX, _key); // ... mt structmt
+		bool equal = lua_rawequal(_luaState, -1, -2) != 0;
+		lua_pop(_luaState, 2); // ...
+		return equal == true ? data : null;
+	}
+	/**
+	 * Get the view at the given index (raise an error if it is not a view of T).
+	 * The metamethods are reachable from the scripts (getmetatable): all of
+	 * them check their first argument.
+	 */
+	template <typename LUAW_TYPE>
+	StructView<LUAW_TYPE>& checkStructView(lua_State* _luaState, int _index) {
+		void* data = toStructUserdata(_luaState, _index, structViewKey<LUAW_TYPE>());
+		if (data == null) {
+			luaL_argerror(_luaState, _index, "struct view expected");
+		}
+		return *static_cast<StructView<LUAW_TYPE>*>(data);
+	}
+	/**
+	 * Get the cursor at the given index (raise an error if it is not a cursor of T).
+	 */
+	template <typename LUAW_TYPE>
+	StructCursor<LUAW_TYPE>& checkStructCursor(lua_State* _luaState, int _index) {
+		void* data = toStructUserdata(_luaState, _index, structCursorKey<LUAW_TYPE>());
+		if (data == null) {
+			luaL_argerror(_luaState, _index, "struct cursor expected");
+		}
+		return *static_cast<StructCursor<LUAW_TYPE>*>(data);
+	}
+
+	/**
+	 * Get the field of the key of a cursor (upvalue 1 is the table name -> field).
+	 */
+	inline const StructField* getStructField(lua_State* _luaState, int _index) {
+		lua_pushvalue(_luaState, _index); // ... key
+		lua_rawget(_luaState, lua_upvalueindex(1)); // ... field
+		const StructField* field = static_cast<const StructField*>(lua_touserdata(_luaState, -1));
+		lua_pop(_luaState, 1); // ...
+		if (field == null) {
+			luaL_error(_luaState, "no field '%s' in the struct", lua_tostring(_luaState, _index));
+		}
+		return field;
+	}
+
+	/**
+	 * Push a new cursor on a view.
+	 * @param[in] _luaState Lua state.
+	 * @param[in] _index Index of the view in the stack (kept alive by the cursor).
+	 * @param[in] _position Index of the record (from 0).
+	 */
+	template <typename LUAW_TYPE>
+	void newStructCursor(lua_State* _luaState, int _index, size_t _position) {
+		_index = lua_absindex(_luaState, _index);
+		StructCursor<LUAW_TYPE>* cursor = static_cast<StructCursor<LUAW_TYPE>*>(lua_newuserdata(_luaState, sizeof(StructCursor<LUAW_TYPE>))); // ... cursor
+		cursor->m_view = static_cast<StructView<LUAW_TYPE>*>(lua_touserdata(_luaState, _index));
+		cursor->m_index = _position;
+		lua_rawgetp(_luaState, LUA_REGISTRYINDEX, structCursorKey<LUAW_TYPE>()); // ... cursor mt
+		lua_setmetatable(_luaState, -2); // ... cursor
+		lua_pushvalue(_luaState, _index); // ... cursor view
+		lua_setuservalue(_luaState, -2); // ... cursor
+	}
+
+	/**
+	 * This function is called from Lua, not C++: cursor.field
+	 */
+	template <typename LUAW_TYPE>
+	int structCursorIndex(lua_State* _luaState) {
+		// cursor key
+		StructCursor<LUAW_TYPE>* cursor = &checkStructCursor<LUAW_TYPE>(_luaState, 1);
+		const StructField* field = getStructField(_luaState, 2);
+		pushStructField(_luaState, *field, cursor->m_view->record(_luaState, cursor->m_index)); // cursor key value
+		return 1;
+	}
+
+	/**
+	 * This function is called from Lua, not C++: cursor.field = value
+	 */
+	template <typename LUAW_TYPE>
+	int structCursorNewindex(lua_State* _luaState) {
+		// cursor key value
+		StructCursor<LUAW_TYPE>* cursor = &checkStructCursor<LUAW_TYPE>(_luaState, 1);
+		if (cursor->m_view->m_readOnly == true) {
+			return luaL_error(_luaState, "the struct view is read-only");
+		}
+		const StructField* field = getStructField(_luaState, 2);
+		setStructField(_luaState, *field, cursor->m_view->record(_luaState, cursor->m_index), 3);
+		return 0;
+	}
+
+	/**
+	 * This function is called from Lua, not C++: view:cursor(i)
+	 */
+	template <typename LUAW_TYPE>
+	int structViewCursor(lua_State* _luaState) {
+		// view index
+		checkStructView<LUAW_TYPE>(_luaState, 1);
+		lua_Integer index = luaL_optinteger(_luaState, 2, 1);
+		luaL_argcheck(_luaState, index >= 1, 2, "index out of range");
+		newStructCursor<LUAW_TYPE>(_luaState, 1, size_t(index) - 1); // view index cursor
+		return 1;
+	}
+
+	/**
+	 * This function is called from Lua, not C++: view:get(i, "field") (upvalue 1
+	 * is the table name -> field).
+	 */
+	template <typename LUAW_TYPE>
+	int structViewGet(lua_State* _luaState) {
+		// view index key
+		StructView<LUAW_TYPE>* view = &checkStructView<LUAW_TYPE>(_luaState, 1);
+		lua_Integer index = luaL_checkinteger(_luaState, 2);
+		luaL_argcheck(_luaState, index >= 1, 2, "index out of range");
+		luaL_checktype(_luaState, 3, LUA_TSTRING);
+		const StructField* field = getStructField(_luaState, 3);
+		pushStructField(_luaState, *field, view->record(_luaState, size_t(index) - 1)); // view index key value
+		return 1;
+	}
+
+	/**
+	 * This function is called from Lua, not C++: view:set(i, "field", value)
+	 * (upvalue 1 is the table name -> field).
+	 */
+	template <typename LUAW_TYPE>
+	int structViewSet(lua_State* _luaState) {
+		// view index key value
+		StructView<LUAW_TYPE>* view = &checkStructView<LUAW_TYPE>(_luaState, 1);
+		if (view->m_readOnly == true) {
+			return luaL_error(_luaState, "the struct view is read-only");
+		}
+		lua_Integer index = luaL_checkinteger(_luaState, 2);
+		luaL_argcheck(_luaState, index >= 1, 2, "index out of range");
+		luaL_checktype(_luaState, 3, LUA_TSTRING);
+		const StructField* field = getStructField(_luaState, 3);
+		setStructField(_luaState, *field, view->record(_luaState, size_t(index) - 1), 4);
+		return 0;
+	}
+
+	/**
+	 * This function is called from Lua, not C++: view[i] or view.method
+	 * (upvalue 1 is the table name -> method).
+	 */
+	template <typename LUAW_TYPE>
+	int structViewIndex(lua_State* _luaState) {
+		// view key
+		StructView<LUAW_TYPE>* view = &checkStructView<LUAW_TYPE>(_luaState, 1);
+		int isInteger = 0;
+		lua_Integer index = lua_tointegerx(_luaState, 2, &isInteger);
+		if (isInteger == 0) {
+			lua_pushvalue(_luaState, 2); // view key key
+			lua_rawget(_luaState, lua_upvalueindex(1)); // view key method
+			return 1;
+		}
+		if (    index < 1
+		     || size_t(index) > view->get(_luaState).size()) {
+			lua_pushnil(_luaState); // view key nil
+			return 1;
+		}
+		// Move the shared cursor.
+		lua_getuservalue(_luaState, 1); // view key cursor
+		static_cast<StructCursor<LUAW_TYPE>*>(lua_touserdata(_luaState, -1))->m_index = size_t(index) - 1;
+		return 1;
+	}
+
+	/**
+	 * This function is called from Lua, not C++: #view
+	 */
+	template <typename LUAW_TYPE>
+	int structViewLen(lua_State* _luaState) {
+		// view
+		etk::Vector<LUAW_TYPE>& vector = checkStructView<LUAW_TYPE>(_luaState, 1).get(_luaState);
+		lua_pushinteger(_luaState, lua_Integer(vector.size())); // view size
+		return 1;
+	}
+
+	/**
+	 * Register the fields of a struct (must be called before pushStructView<T>).
+	 * @param[in] _luaState Lua state.
+	 * @param[in] _fields Fields of the struct, ended with a NULL name (must outlive the state).
+	 */
+	template <typename LUAW_TYPE>
+	void registerStruct(lua_State* _luaState, const StructField* _fields) {
+		// Fields: name -> StructField*
+		lua_newtable(_luaState); // ... fields
+		for (const StructField* field = _fields; field->m_name != null; ++field) {
+			lua_pushlightuserdata(_luaState, const_cast<StructField*>(field)); // ... fields field
+			lua_setfield(_luaState, -2, field->m_name); // ... fields
+		}
+		lua_createtable(_luaState, 0, 2); // ... fields cursormt
+		lua_pushvalue(_luaState, -2); // ... fields cursormt fields
+		lua_pushcclosure(_luaState, structCursorIndex<LUAW_TYPE>, 1); // ... fields cursormt index
+		lua_setfield(_luaState, -2, "__index"); // ... fields cursormt
+		lua_pushvalue(_luaState, -2); // ... fields cursormt fields
+		lua_pushcclosure(_luaState, structCursorNewindex<LUAW_TYPE>, 1); // ... fields cursormt newindex
+		lua_setfield(_luaState, -2, "__newindex"); // ... fields cursormt
+		lua_rawsetp(_luaState, LUA_REGISTRYINDEX, structCursorKey<LUAW_TYPE>()); // ... fields
+		// Methods of the views: name -> function
+		lua_createtable(_luaState, 0, 3); // ... fields methods
+		lua_pushcfunction(_luaState, structViewCursor<LUAW_TYPE>); // ... fields methods cursor
+		lua_setfield(_luaState, -2, "cursor"); // ... fields methods
+		lua_pushvalue(_luaState, -2); // ... fields methods fields
+		lua_pushcclosure(_luaState, structViewGet<LUAW_TYPE>, 1); // ... fields methods get
+		lua_setfield(_luaState, -2, "get"); // ... fields methods
+		lua_pushvalue(_luaState, -2); // ... fields methods fields
+		lua_pushcclosure(_luaState, structViewSet<LUAW_TYPE>, 1); // ... fields methods set
+		lua_setfield(_luaState, -2, "set"); // ... fields methods
+		lua_createtable(_luaState, 0, 2); // ... fields methods viewmt
+		lua_pushvalue(_luaState, -2); // ... fields methods viewmt methods
+		lua_pushcclosure(_luaState, structViewIndex<LUAW_TYPE>, 1); // ... fields methods viewmt index
+		lua_setfield(_luaState, -2, "__index"); // ... fields methods viewmt
+		lua_pushcfunction(_luaState, structViewLen<LUAW_TYPE>); // ... fields methods viewmt len
+		lua_setfield(_luaState, -2, "__len"); // ... fields methods viewmt
+		lua_rawsetp(_luaState, LUA_REGISTRYINDEX, structViewKey<LUAW_TYPE>()); // ... fields methods
+		lua_pop(_luaState, 2); // ...
+	}
+
+	/**
+	 * Push a view of a vector of structs (see StructView).
+	 * @param[in] _luaState Lua state.
+	 * @param[in] _vector Viewed vector.
+	 * @param[in] _readOnly The script can not change the records.
+	 * @param[in] _generationCounter Generation of the vector (NULL if the vector outlive the state).
+	 */
+	template <typename LUAW_TYPE>
+	void pushStructView(lua_State* _luaState,
+	                    etk::Vector<LUAW_TYPE>* _vector,
+	                    bool _readOnly,
+	                    const uint32_t* _generationCounter = null) {
+		StructView<LUAW_TYPE>* view = static_cast<StructView<LUAW_TYPE>*>(lua_newuserdata(_luaState, sizeof(StructView<LUAW_TYPE>))); // ... view
+		view->m_vector = _vector;
+		view->m_readOnly = _readOnly;
+		view->m_generationCounter = _generationCounter;
+		view->m_generation = _generationCounter != null ? *_generationCounter : 0;
+		if (lua_rawgetp(_luaState, LUA_REGISTRYINDEX, structViewKey<LUAW_TYPE>()) != LUA_TTABLE) {
+			luaL_error(_luaState, "struct not registered (call registerStruct)");
+		}
+		// ... view mt
+		lua_setmetatable(_luaState, -2); // ... view
+		// The shared cursor of view[i].
+		newStructCursor<LUAW_TYPE>(_luaState, -1, 0); // ... view cursor
+		lua_setuservalue(_luaState, -2); // ... view
+	}
+	template <typename LUAW_TYPE>
+	void pushStructView(lua_State* _luaState,
+	                    etk::Vector<LUAW_TYPE>& _vector,
+	                    const uint32_t* _generationCounter = null) {
+		pushStructView<LUAW_TYPE>(_luaState, &_vector, false, _generationCounter);
+	}
+	template <typename LUAW_TYPE>
+	void pushStructView(lua_State* _luaState,
+	                    const etk::Vector<LUAW_TYPE>& _vector,
+	                    const uint32_t* _generationCounter = null) {
+		pushStructView<LUAW_TYPE>(_luaState, const_cast<etk::Vector<LUAW_TYPE>*>(&_vector), true, _generationCounter);
+	}
+}
@@ -0,0 +1,198 @@
+/** @file
+ * @author Edouard DUPIN
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/Symbol.hpp>
+
+namespace {
+	/**
+	 * Symbols of a state. It lives in a userdata stored in the registry (key:
+	 * symbolTableKey), its user value is the lua table string -> ID (that
+	 * reference the strings: their address does not change while the state lives).
+	 */
+	class SymbolTable {
+		private:
+			etk::Vector<const char*> m_cacheKey; //!< address of the strings (open addressing, power of 2 size, NULL: free)
+			etk::Vector<uint32_t> m_cacheId; //!< ID of m_cacheKey[x]
+			size_t m_cacheCount = 0; //!< number of addresses in the cache
+			etk::Vector<etk::String> m_names; //!< name of each ID
+			size_t slot(const char* _data) const {
+				// The strings are aligned: the low bits are removed before the mix.
+				return size_t((uint64_t(reinterpret_cast<uintptr_t>(_data) >> 3) * 0x9E3779B97F4A7C15ULL) >> 32) & (m_cacheKey.size() - 1);
+			}
+		public:
+			/**
+			 * Find the ID of a string from its address (luaWrapper::Symbol::invalid if it is not in the cache).
+			 */
+			uint32_t find(const char* _data) const {
+				if (m_cacheKey.size() == 0) {
+					return luaWrapper::Symbol::invalid;
+				}
+				for (size_t iii=slot(_data); m_cacheKey[iii] != null; iii=(iii + 1) & (m_cacheKey.size() - 1)) {
+					if (m_cacheKey[iii] == _data) {
+						return m_cacheId[iii];
+					}
+				}
+				return luaWrapper::Symbol::invalid;
+			}
+			/**
+			 * Add the address of the lua string of a symbol in the cache.
+			 */
+			void insert(const char* _data, uint32_t _id) {
+				if ((m_cacheCount + 1) * 2 > m_cacheKey.size()) {
+					// Keep the load under 50% (short probe sequences).
+					etk::Vector<const char*> keys = m_cacheKey;
+					etk::Vector<uint32_t> ids = m_cacheId;
+					size_t size = m_cacheKey.size() == 0 ? 16 : m_cacheKey.size() * 2;
+					m_cacheKey.clear();
+					m_cacheKey.resize(size, null);
+					m_cacheId.clear();
+					m_cacheId.resize(size, 0);
+					m_cacheCount = 0;
+					for (size_t iii=0; iii<keys.size(); ++iii) {
+						if (keys[iii] != null) {
+							insert(keys[iii], ids[iii]);
+						}
+					}
+				}
+				size_t iii = slot(_data);
+				while (m_cacheKey[iii] != null) {
+					iii = (iii + 1) & (m_cacheKey.size() - 1);
+				}
+				m_cacheKey[iii] = _data;
+				m_cacheId[iii] = _id;
+				m_cacheCount++;
+			}
+			/**
+			 * Create the next ID.
+			 */
+			uint32_t add(const char* _name, size_t _size) {
+				m_names.pushBack(etk::String(_name, _size));
+				return uint32_t(m_names.size() - 1);
+			}
+			const etk::String* getName(uint32_t _id) const {
+				if (_id >= m_names.size()) {
+					return null;
+				}
+				return &m_names[_id];
+			}
+	};
+
+	/**
+	 * The address of this variable is the registry key of the SymbolTable.
+	 */
+	const void* symbolTableKey() {
+		static const char g_key = 0;
+		return &g_key;
+	}
+
+	int gcSymbolTable(lua_State* _luaState) {
+		SymbolTable* table = static_cast<SymbolTable*>(lua_touserdata(_luaState, 1));
+		table->~SymbolTable();
+		return 0;
+	}
+
+	/**
+	 * Push the symbol table userdata (created on the first use in the state).
+	 */
+	SymbolTable* pushSymbolTable(lua_State* _luaState) {
+		if (lua_rawgetp(_luaState, LUA_REGISTRYINDEX, symbolTableKey()) == LUA_TUSERDATA) {
+			// ... symbols
+			return static_cast<SymbolTable*>(lua_touserdata(_luaState, -1));
+		}
+		lua_pop(_luaState, 1); // ...
+		SymbolTable* table = new (static_cast<char*>(lua_newuserdata(_luaState, sizeof(SymbolTable)))) SymbolTable(); // ... symbols
+		lua_createtable(_luaState, 0, 1); // ... symbols {}
+		lua_pushcfunction(_luaState, gcSymbolTable); // ... symbols {} gc
+		lua_setfield(_luaState, -2, "__gc"); // ... symbols {}
+		lua_setmetatable(_luaState, -2); // ... symbols
+		lua_newtable(_luaState); // ... symbols {}
+		lua_setuservalue(_luaState, -2); // ... symbols
+		lua_pushvalue(_luaState, -1); // ... symbols symbols
+		lua_rawsetp(_luaState, LUA_REGISTRYINDEX, symbolTableKey()); // ... symbols
+		return table;
+	}
+}
+
+luaWrapper::Symbol luaWrapper::internSymbol(lua_State* _luaState, const char* _name, size_t _size) {
+	lua_pushlstring(_luaState, _name, _size); // ... name
+	Symbol symbol = toSymbol(_luaState, -1);
+	if (symbol.isValid() == true) {
+		lua_pop(_luaState, 1); // ...
+		return symbol;
+	}
+	SymbolTable* table = pushSymbolTable(_luaState); // ... name symbols
+	uint32_t id = table->add(_name, _size);
+	lua_getuservalue(_luaState, -1); // ... name symbols ids
+	lua_pushvalue(_luaState, -3); // ... name symbols ids name
+	lua_pushinteger(_luaState, lua_Integer(id)); // ... name symbols ids name id
+	lua_rawset(_luaState, -3); // ... name symbols ids
+	// The string is now referenced by the table: its address is stable.
+	table->insert(lua_tostring(_luaState, -3), id);
+	lua_pop(_luaState, 3); // ...
+	return Symbol(id);
+}
+
+luaWrapper::Symbol luaWrapper::toSymbol(lua_State* _luaState, int _index) {
+	if (lua_type(_luaState, _index) != LUA_TSTRING) {
+		return Symbol();
+	}
+	_index = lua_absindex(_luaState, _index);
+	const char* data = lua_tostring(_luaState, _index);
+	SymbolTable* table = pushSymbolTable(_luaState); // ... symbols
+	uint32_t id = table->find(data);
+	if (id == Symbol::invalid) {
+		// Not the string of a symbol (or a long string): lookup by value.
+		lua_getuservalue(_luaState, -1); // ... symbols ids
+		lua_pushvalue(_luaState, _index); // ... symbols ids name
+		if (lua_rawget(_luaState, -2) == LUA_TNUMBER) {
+			// ... symbols ids id
+			id = uint32_t(lua_tointeger(_luaState, -1));
+		}
+		lua_pop(_luaState, 2); // ... symbols
+	}
+	lua_pop(_luaState, 1); // ...
+	return Symbol(id);
+}
+
+luaWrapper::Symbol luaWrapper::checkSymbol(lua_State* _luaState, int _index) {
+	luaL_checktype(_luaState, _index, LUA_TSTRING);
+	return toSymbol(_luaState, _index);
+}
+
+void luaWrapper::pushSymbol(lua_State* _luaState, luaWrapper::Symbol _symbol) {
+	SymbolTable* table = pushSymbolTable(_luaState); // ... symbols
+	lua_pop(_luaState, 1); // ...
+	const etk::String* name = table->getName(_symbol.getId());
+	if (name == null) {
+		lua_pushnil(_luaState); // ... nil
+		return;
+	}
+	lua_pushlstring(_luaState, name->c_str(), name->size()); // ... name
+}
+
+etk::String luaWrapper::getSymbolName(lua_State* _luaState, luaWrapper::Symbol _symbol) {
+	SymbolTable* table = pushSymbolTable(_luaState); // ... symbols
+	lua_pop(_luaState, 1); // ...
+	const etk::String* name = table->getName(_symbol.getId());
+	if (name == null) {
+		return etk::String();
+	}
+	return *name;
+}
+
+namespace luaWrapper {
+	namespace utils {
+		template<> Symbol Converter<Symbol>::check(lua_State* _luaState, int _index) {
+			return checkSymbol(_luaState, _index);
+		}
+		template<> Symbol Converter<Symbol>::to(lua_State* _luaState, int _index) {
+			return toSymbol(_luaState, _index);
+		}
+		template<> void Converter<Symbol>::push(lua_State* _luaState, const Symbol& _value) {
+			pushSymbol(_luaState, _value);
+		}
+	}
+}
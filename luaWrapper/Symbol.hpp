@@ -0,0 +1,77 @@
+/** @file
+ * @author Edouard DUPIN
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <luaWrapper/luaWrapper.hpp>
+
+namespace luaWrapper {
+	/**
+	 * Dense integer ID of a string interned in a state (event names, component
+	 * keys...): the bindings compare IDs instead of strings.
+	 *
+	 *   enum { eventClick, eventHover }; // interned in this order at the start: the IDs are the same
+	 *   luaWrapper::internSymbol(L, "click");
+	 *   luaWrapper::internSymbol(L, "hover");
+	 *   ...
+	 *   switch (luaWrapper::utils::check<luaWrapper::Symbol>(L, 1).getId()) {
+	 *   	case eventClick: ...
+	 *
+	 * The lua strings of the symbols are referenced by the state: a short lua
+	 * string is unique, so its address identify the symbol, and check/to find
+	 * it in a cache keyed by the address (no copy, no hash of the string). The
+	 * other strings (long strings) are found with a lookup in a lua table.
+	 *
+	 * Only C++ create the symbols: an unknown string give an invalid symbol
+	 * (a script can not grow the table).
+	 */
+	class Symbol {
+		public:
+			static const uint32_t invalid = 0xFFFFFFFF; //!< ID of a string that is not a symbol
+		private:
+			uint32_t m_id;
+		public:
+			explicit Symbol(uint32_t _id = invalid) :
+			  m_id(_id) {
+
+			}
+			uint32_t getId() const {
+				return m_id;
+			}
+			bool isValid() const {
+				return m_id != invalid;
+			}
+			bool operator==(const Symbol& _obj) const {
+				return m_id == _obj.m_id;
+			}
+			bool operator!=(const Symbol& _obj) const {
+				return m_id != _obj.m_id;
+			}
+	};
+	/**
+	 * Get the symbol of a string (created with the next ID if it does not exist).
+	 */
+	Symbol internSymbol(lua_State* _luaState, const char* _name, size_t _size);
+	inline Symbol internSymbol(lua_State* _luaState, const etk::String& _name) {
+		return internSymbol(_luaState, _name.c_str(), _name.size());
+	}
+	/**
+	 * Get the symbol of the string at the given index (invalid if the value is
+	 * not a string or not a symbol).
+	 */
+	Symbol toSymbol(lua_State* _luaState, int _index);
+	/**
+	 * Same as toSymbol, but raise an error if the value is not a string.
+	 */
+	Symbol checkSymbol(lua_State* _luaState, int _index);
+	/**
+	 * Push the string of a symbol (nil if it is invalid).
+	 */
+	void pushSymbol(lua_State* _luaState, Symbol _symbol);
+	/**
+	 * Get the string of a symbol (empty if it is invalid).
+	 */
+	etk::String getSymbolName(lua_State* _luaState, Symbol _symbol);
+}
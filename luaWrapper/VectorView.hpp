@@ -0,0 +1,220 @@
+/** @file
+ * @author Edouard DUPIN
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <luaWrapper/luaWrapper.hpp>
+
+namespace luaWrapper {
+	/**
+	 * Lazy view of an etk::Vector: a small userdata that reference the vector
+	 * instead of copying it in a table (utils::push<etk::Vector<T>>). The
+	 * elements are converted with utils::push/check only when the script access
+	 * them:
+	 *
+	 *   luaWrapper::pushView<Item>(L, m_inventory); // or a const vector: read-only
+	 *
+	 * Lua: view[i], view[i] = v, view[#view + 1] = v (pushBack), #view,
+	 * pairs(view) and ipairs(view).
+	 *
+	 * The view does not own the vector: it must stay alive as long as the
+	 * script can use the view, or give a generation counter (see pushBorrowed)
+	 * that is incremented when the vector is destroyed: a stale view raises a
+	 * lua error instead of a use after free.
+	 */
+	template <typename LUAW_TYPE>
+	class VectorView {
+		public:
+			etk::Vector<LUAW_TYPE>* m_vector; //!< the viewed vector
+			bool m_readOnly; //!< no __newindex (the vector was given const)
+			const uint32_t* m_generationCounter; //!< generation counter of the vector (or NULL)
+			uint32_t m_generation; //!< value of *m_generationCounter when the view has been pushed
+			/**
+			 * Get the vector (raise a lua error if it has been destroyed).
+			 */
+			etk::Vector<LUAW_TYPE>& get(lua_State* _luaState) {
+				if (    m_generationCounter != null
+				     && *m_generationCounter != m_generation) {
+					luaL_error(_luaState, "the vector of the view has been destroyed");
+				}
+				return *m_vector;
+			}
+	};
+
+	/**
+	 * The address of this variable is the registry key of the metatable of the
+	 * views of etk::Vector<T>.
+	 */
+	template <typename LUAW_TYPE>
+	inline const void* vectorViewKey() {
+		static const char g_key = 0;
+		return &g_key;
+	}
+
+	/**
+	 * Get the view at the given index, or NULL if it is not a view of an etk::Vector<T>.
+	 */
+	template <typename LUAW_TYPE>
+	VectorView<LUAW_TYPE>* toVectorView(lua_State* _luaState, int _index) {
+		void* data = lua_touserdata(_luaState, _index);
+		if (    data == null
+		     || lua_getmetatable(_luaState, _index) == 0) {
+			return null;
+		}
+		// ... mt
+		lua_rawgetp(_luaState, LUA_REGISTRYINDEX, vectorViewKey<LUAW_TYPE>()); // ... mt viewmt
+		bool equal = lua_rawequal(_luaState, -1, -2) != 0;
+		lua_pop(_luaState, 2); // ...
+		return equal == true ? static_cast<VectorView<LUAW_TYPE>*>(data) : null;
+	}
+
+	/**
+	 * Get the vector of the view at the given index (raise an error if it is not
+	 * a view of an etk::Vector<T>, or if the vector has been destroyed).
+	 */
+	template <typename LUAW_TYPE>
+	etk::Vector<LUAW_TYPE>& checkVectorView(lua_State* _luaState, int _index) {
+		VectorView<LUAW_TYPE>* view = toVectorView<LUAW_TYPE>(_luaState, _index);
+		if (view == null) {
+			luaL_argerror(_luaState, _index, "vector view expected");
+		}
+		return view->get(_luaState);
+	}
+
+	/**
+	 * This function is called from Lua, not C++: view[key]
+	 */
+	template <typename LUAW_TYPE>
+	int vectorViewIndex(lua_State* _luaState) {
+		// view key
+		etk::Vector<LUAW_TYPE>& vector = checkVectorView<LUAW_TYPE>(_luaState, 1);
+		int isInteger = 0;
+		lua_Integer index = lua_tointegerx(_luaState, 2, &isInteger);
+		if (    isInteger == 0
+		     || index < 1
+		     || size_t(index) > vector.size()) {
+			lua_pushnil(_luaState); // view key nil
+			return 1;
+		}
+		luaWrapper::utils::push<LUAW_TYPE>(_luaState, vector[size_t(index) - 1]); // view key value
+		return 1;
+	}
+
+	/**
+	 * This function is called from Lua, not C++: view[key] = value
+	 */
+	template <typename LUAW_TYPE>
+	int vectorViewNewindex(lua_State* _luaState) {
+		// view key value
+		VectorView<LUAW_TYPE>* view = toVectorView<LUAW_TYPE>(_luaState, 1);
+		if (view == null) {
+			return luaL_argerror(_luaState, 1, "vector view expected");
+		}
+		etk::Vector<LUAW_TYPE>& vector = view->get(_luaState);
+		if (view->m_readOnly == true) {
+			return luaL_error(_luaState, "the vector view is read-only");
+		}
+		lua_Integer index = luaL_checkinteger(_luaState, 2);
+		if (    index < 1
+		     || size_t(index) > vector.size() + 1) {
+			return luaL_error(_luaState, "vector view index %d out of range [1..%d]", int(index), int(vector.size() + 1));
+		}
+		if (size_t(index) == vector.size() + 1) {
+			vector.pushBack(luaWrapper::utils::check<LUAW_TYPE>(_luaState, 3));
+		} else {
+			vector[size_t(index) - 1] = luaWrapper::utils::check<LUAW_TYPE>(_luaState, 3);
+		}
+		return 0;
+	}
+
+	/**
+	 * This function is called from Lua, not C++: #view
+	 */
+	template <typename LUAW_TYPE>
+	int vectorViewLen(lua_State* _luaState) {
+		// view
+		etk::Vector<LUAW_TYPE>& vector = checkVectorView<LUAW_TYPE>(_luaState, 1);
+		lua_pushinteger(_luaState, lua_Integer(vector.size())); // view size
+		return 1;
+	}
+
+	/**
+	 * This function is called from Lua, not C++: iterator of pairs/ipairs.
+	 */
+	template <typename LUAW_TYPE>
+	int vectorViewNext(lua_State* _luaState) {
+		// view index
+		etk::Vector<LUAW_TYPE>& vector = checkVectorView<LUAW_TYPE>(_luaState, 1);
+		lua_Integer index = lua_isnil(_luaState, 2) ? 1 : luaL_checkinteger(_luaState, 2) + 1;
+		if (    index < 1
+		     || size_t(index) > vector.size()) {
+			return 0;
+		}
+		lua_pushinteger(_luaState, index); // view index index
+		luaWrapper::utils::push<LUAW_TYPE>(_luaState, vector[size_t(index) - 1]); // view index index value
+		return 2;
+	}
+
+	/**
+	 * This function is called from Lua, not C++: pairs(view) and ipairs(view).
+	 */
+	template <typename LUAW_TYPE>
+	int vectorViewPairs(lua_State* _luaState) {
+		// view
+		lua_pushcfunction(_luaState, vectorViewNext<LUAW_TYPE>); // view next
+		lua_pushvalue(_luaState, 1); // view next view
+		lua_pushnil(_luaState); // view next view nil
+		return 3;
+	}
+
+	/**
+	 * Push a view of a vector (see VectorView).
+	 * @param[in] _luaState Lua state.
+	 * @param[in] _vector Viewed vector.
+	 * @param[in] _readOnly The script can not change the vector.
+	 * @param[in] _generationCounter Generation of the vector (NULL if the vector outlive the state).
+	 */
+	template <typename LUAW_TYPE>
+	void pushView(lua_State* _luaState,
+	              etk::Vector<LUAW_TYPE>* _vector,
+	              bool _readOnly,
+	              const uint32_t* _generationCounter = null) {
+		VectorView<LUAW_TYPE>* view = static_cast<VectorView<LUAW_TYPE>*>(lua_newuserdata(_luaState, sizeof(VectorView<LUAW_TYPE>))); // ... view
+		view->m_vector = _vector;
+		view->m_readOnly = _readOnly;
+		view->m_generationCounter = _generationCounter;
+		view->m_generation = _generationCounter != null ? *_generationCounter : 0;
+		// The metatable is created on the first use of a type in the state.
+		if (lua_rawgetp(_luaState, LUA_REGISTRYINDEX, vectorViewKey<LUAW_TYPE>()) != LUA_TTABLE) {
+			// ... view nil
+			lua_pop(_luaState, 1); // ... view
+			const luaL_Reg metatable[] = {
+				{ "__index", vectorViewIndex<LUAW_TYPE> },
+				{ "__newindex", vectorViewNewindex<LUAW_TYPE> },
+				{ "__len", vectorViewLen<LUAW_TYPE> },
+				{ "__pairs", vectorViewPairs<LUAW_TYPE> },
+				{ "__ipairs", vectorViewPairs<LUAW_TYPE> },
+				{ NULL, NULL }
+			};
+			lua_createtable(_luaState, 0, 5); // ... view mt
+			luaL_setfuncs(_luaState, metatable, 0); // ... view mt
+			lua_pushvalue(_luaState, -1); // ... view mt mt
+			lua_rawsetp(_luaState, LUA_REGISTRYINDEX, vectorViewKey<LUAW_TYPE>()); // ... view mt
+		}
+		lua_setmetatable(_luaState, -2); // ... view
+	}
+	template <typename LUAW_TYPE>
+	void pushView(lua_State* _luaState,
+	              etk::Vector<LUAW_TYPE>& _vector,
+	              const uint32_t* _generationCounter = null) {
+		pushView<LUAW_TYPE>(_luaState, &_vector, false, _generationCounter);
+	}
+	template <typename LUAW_TYPE>
+	void pushView(lua_State* _luaState,
+	              const etk::Vector<LUAW_TYPE>& _vector,
+	              const uint32_t* _generationCounter = null) {
+		pushView<LUAW_TYPE>(_luaState, const_cast<etk::Vector<LUAW_TYPE>*>(&_vector), true, _generationCounter);
+	}
+}
@@ -21,6 +21,7 @@
  *  luaWrapper::registerElement<LUAW_TYPE>
  *  luaWrapper::setfuncs<LUAW_TYPE>
  *  luaWrapper::extend<LUAW_TYPE, LUAW_TYPE2>
+ *  luaWrapper::seal<LUAW_TYPE>
  *  luaWrapper::hold<LUAW_TYPE>
  *  luaWrapper::release<LUAW_TYPE>
  *
@@ -43,23 +44,405 @@
 #include <etk/Allocator.hpp>
 #include <etk/os/FSNode.hpp>
 #include <etk/Exception.hpp>
+#include <etk/Vector.hpp>
+#include <etk/Pair.hpp>
+#include <etk/Map.hpp>
+#include <etk/String.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
 
 #include <luaWrapper/debug.hpp>
+#include <luaWrapper/AllocationProfiler.hpp>
 
 #define LUAW_POSTCTOR_KEY "__postctor"
 #define LUAW_EXTENDS_KEY "__extends"
-#define LUAW_STORAGE_KEY "storage"
 #define LUAW_CACHE_KEY "cache"
 #define LUAW_CACHE_METATABLE_KEY "cachemetatable"
 #define LUAW_HOLDS_KEY "holds"
+#define LUAW_GETTERS_KEY "__getters"
+#define LUAW_SETTERS_KEY "__setters"
 #define LUAW_WRAPPER_KEY "LuaWrapper"
+#define LUAW_USERDATA_MAGIC (0x4C554157) // "LUAW"
+#define LUAW_VALUE_MAGIC (0x4C554156) // "LUAV"
 
 namespace luaWrapper {
+	/**
+	 * Read-only view of a lua string (pointer and length, embedded '\0'
+	 * allowed), without copy: use it instead of etk::String for the arguments
+	 * that are only read (utils::check<luaWrapper::StringView>).
+	 *
+	 * The data belong to the lua string: the view is valid while the value
+	 * stays on the stack (or is referenced from lua).
+	 */
+	class StringView {
+		private:
+			const char* m_data; //!< data of the lua string (ends with a '\0')
+			size_t m_size; //!< number of bytes (without the final '\0')
+		public:
+			StringView() :
+			  m_data(""),
+			  m_size(0) {
+				
+			}
+			StringView(const char* _data, size_t _size) :
+			  m_data(_data),
+			  m_size(_size) {
+				
+			}
+			const char* data() const {
+				return m_data;
+			}
+			size_t size() const {
+				return m_size;
+			}
+			bool empty() const {
+				return m_size == 0;
+			}
+			char operator[](size_t _pos) const {
+				return m_data[_pos];
+			}
+			bool operator==(const StringView& _obj) const {
+				return    m_size == _obj.m_size
+				       && memcmp(m_data, _obj.m_data, m_size) == 0;
+			}
+			bool operator!=(const StringView& _obj) const {
+				return !(*this == _obj);
+			}
+			/**
+			 * Copy the data in a string (to keep it after the value is removed from the stack).
+			 */
+			etk::String toString() const {
+				return etk::String(m_data, m_size);
+			}
+	};
 	namespace utils {
-		template<typename LUAW_TYPE> LUAW_TYPE check(lua_State* _luaState, int _index);
-		template<typename LUAW_TYPE> LUAW_TYPE to(lua_State* _luaState, int _index);
-		template<typename LUAW_TYPE> void push(lua_State* _luaState, const LUAW_TYPE& _value);
+		/**
+		 * Conversion of a C++ value from/to lua, used by check, to and push. The
+		 * members are defined for the scalar types, etk::String and StringView in
+		 * luaWrapperEtk.cpp, and the class is specialized for the containers
+		 * (etk::Vector, etk::Map, etk::Pair). To convert your own type, specialize
+		 * the functions check/to/push (or this class for a template).
+		 */
+		template<typename LUAW_TYPE> struct Converter {
+			static LUAW_TYPE check(lua_State* _luaState, int _index);
+			static LUAW_TYPE to(lua_State* _luaState, int _index);
+			static void push(lua_State* _luaState, const LUAW_TYPE& _value);
+		};
+		template<typename LUAW_TYPE> LUAW_TYPE check(lua_State* _luaState, int _index) {
+			return Converter<LUAW_TYPE>::check(_luaState, _index);
+		}
+		template<typename LUAW_TYPE> LUAW_TYPE to(lua_State* _luaState, int _index) {
+			return Converter<LUAW_TYPE>::to(_luaState, _index);
+		}
+		template<typename LUAW_TYPE> void push(lua_State* _luaState, const LUAW_TYPE& _value) {
+			Converter<LUAW_TYPE>::push(_luaState, _value);
+		}
+		
+		/**
+		 * Explicit check of the type of an element of a container, before its
+		 * conversion: Converter<T>::check would report the error on the stack
+		 * index of the element (ex: "bad argument #-1"). The types without a
+		 * known lua type (bool, the user converters) are not checked here.
+		 */
+		template<typename LUAW_TYPE, typename LUAW_ENABLE = void> struct ElementCheck {
+			static const char* expected() {
+				return null;
+			}
+			static bool is(lua_State* _luaState, int _index) {
+				return true;
+			}
+		};
+		template<typename LUAW_TYPE> struct ElementCheck<LUAW_TYPE, typename std::enable_if<    std::is_integral<LUAW_TYPE>::value == true
+		                                                                                     && std::is_same<LUAW_TYPE, bool>::value == false>::type> {
+			static const char* expected() {
+				return "integer";
+			}
+			static bool is(lua_State* _luaState, int _index) {
+				int isInteger = 0;
+				lua_tointegerx(_luaState, _index, &isInteger);
+				return isInteger != 0;
+			}
+		};
+		template<typename LUAW_TYPE> struct ElementCheck<LUAW_TYPE, typename std::enable_if<std::is_floating_point<LUAW_TYPE>::value == true>::type> {
+			static const char* expected() {
+				return "number";
+			}
+			static bool is(lua_State* _luaState, int _index) {
+				return lua_isnumber(_luaState, _index) != 0;
+			}
+		};
+		template<typename LUAW_TYPE> struct ElementCheckString {
+			static const char* expected() {
+				return "string";
+			}
+			static bool is(lua_State* _luaState, int _index) {
+				return lua_isstring(_luaState, _index) != 0;
+			}
+		};
+		template<> struct ElementCheck<etk::String> : public ElementCheckString<etk::String> {};
+		template<> struct ElementCheck<StringView> : public ElementCheckString<StringView> {};
+		template<> struct ElementCheck<const char*> : public ElementCheckString<const char*> {};
+		template<typename LUAW_TYPE> struct ElementCheckTable {
+			static const char* expected() {
+				return "table";
+			}
+			static bool is(lua_State* _luaState, int _index) {
+				return lua_istable(_luaState, _index);
+			}
+		};
+		template<typename LUAW_TYPE> struct ElementCheck<etk::Vector<LUAW_TYPE>> : public ElementCheckTable<etk::Vector<LUAW_TYPE>> {};
+		template<typename LUAW_KEY, typename LUAW_VALUE> struct ElementCheck<etk::Map<LUAW_KEY, LUAW_VALUE>> : public ElementCheckTable<etk::Map<LUAW_KEY, LUAW_VALUE>> {};
+		template<typename LUAW_TYPE, typename LUAW_TYPE2> struct ElementCheck<etk::Pair<LUAW_TYPE, LUAW_TYPE2>> : public ElementCheckTable<etk::Pair<LUAW_TYPE, LUAW_TYPE2>> {};
+		
+		/**
+		 * Raise the error of a bad element (or key) of a container.
+		 * @param[in] _luaState Lua state.
+		 * @param[in] _container Index of the container in the stack (argument number).
+		 * @param[in] _key Index of the key of the element in the stack.
+		 * @param[in] _value Index of the bad value (the element or its key).
+		 * @param[in] _what "element" or "key".
+		 * @param[in] _expected Name of the expected type.
+		 */
+		inline int elementError(lua_State* _luaState, int _container, int _key, int _value, const char* _what, const char* _expected) {
+			const char* got = luaL_typename(_luaState, _value);
+			if (lua_type(_luaState, _key) == LUA_TSTRING) {
+				return luaL_error(_luaState, "bad argument #%d (%s expected for the %s '%s', got %s)", _container, _expected, _what, lua_tostring(_luaState, _key), got);
+			}
+			if (lua_type(_luaState, _key) == LUA_TNUMBER) {
+				// Converted on a copy: the key can still be used by lua_next.
+				lua_pushvalue(_luaState, _key); // ... key
+				return luaL_error(_luaState, "bad argument #%d (%s expected for the %s %s, got %s)", _container, _expected, _what, lua_tostring(_luaState, -1), got);
+			}
+			return luaL_error(_luaState, "bad argument #%d (%s expected for a %s, got %s)", _container, _expected, _what, got);
+		}
+		
+		/**
+		 * Check the type of the element at the top of the stack, and convert it.
+		 * @param[in] _luaState Lua state.
+		 * @param[in] _container Index of the container in the stack (argument number).
+		 * @param[in] _key Index of the key of the element in the stack.
+		 * @param[in] _value Index of the value to convert (the element or its key).
+		 * @param[in] _what "element" or "key".
+		 */
+		template<typename LUAW_TYPE> LUAW_TYPE checkElement(lua_State* _luaState, int _container, int _key, int _value, const char* _what) {
+			if (ElementCheck<LUAW_TYPE>::is(_luaState, _value) == false) {
+				elementError(_luaState, _container, _key, _value, _what, ElementCheck<LUAW_TYPE>::expected());
+			}
+			return luaWrapper::utils::check<LUAW_TYPE>(_luaState, _value);
+		}
+		
+		/**
+		 * etk::Vector <-> sequence {v1, v2, ...}. The table is created with its
+		 * final size (lua_createtable) and the vector is reserved (lua_rawlen):
+		 * no rehash and no reallocation during the copy.
+		 */
+		template<typename LUAW_TYPE> struct Converter<etk::Vector<LUAW_TYPE>> {
+			static etk::Vector<LUAW_TYPE> check(lua_State* _luaState, int _index) {
+				luaL_checktype(_luaState, _index, LUA_TTABLE);
+				return get(_luaState, _index, true);
+			}
+			static etk::Vector<LUAW_TYPE> to(lua_State* _luaState, int _index) {
+				if (lua_type(_luaState, _index) != LUA_TTABLE) {
+					return etk::Vector<LUAW_TYPE>();
+				}
+				return get(_luaState, _index, false);
+			}
+			static void push(lua_State* _luaState, const etk::Vector<LUAW_TYPE>& _value) {
+				lua_createtable(_luaState, int(_value.size()), 0); // ... {}
+				for (size_t iii=0; iii<_value.size(); ++iii) {
+					luaWrapper::utils::push<LUAW_TYPE>(_luaState, _value[iii]); // ... {} value
+					lua_rawseti(_luaState, -2, lua_Integer(iii + 1)); // ... {}
+				}
+			}
+			private:
+				static etk::Vector<LUAW_TYPE> get(lua_State* _luaState, int _index, bool _check) {
+					int index = lua_absindex(_luaState, _index);
+					size_t size = lua_rawlen(_luaState, index);
+					etk::Vector<LUAW_TYPE> out;
+					out.reserve(size);
+					for (size_t iii=1; iii<=size; ++iii) {
+						lua_rawgeti(_luaState, index, lua_Integer(iii)); // ... value
+						if (_check == true) {
+							lua_pushinteger(_luaState, lua_Integer(iii)); // ... value key
+							out.pushBack(luaWrapper::utils::checkElement<LUAW_TYPE>(_luaState, index, -1, -2, "element"));
+							lua_pop(_luaState, 1); // ... value
+						} else {
+							out.pushBack(luaWrapper::utils::to<LUAW_TYPE>(_luaState, -1));
+						}
+						lua_pop(_luaState, 1); // ...
+					}
+					return out;
+				}
+		};
+		
+		/**
+		 * etk::Map <-> table {key = value, ...} (presized on both sides).
+		 */
+		template<typename LUAW_KEY, typename LUAW_VALUE> struct Converter<etk::Map<LUAW_KEY, LUAW_VALUE>> {
+			static etk::Map<LUAW_KEY, LUAW_VALUE> check(lua_State* _luaState, int _index) {
+				luaL_checktype(_luaState, _index, LUA_TTABLE);
+				return get(_luaState, _index, true);
+			}
+			static etk::Map<LUAW_KEY, LUAW_VALUE> to(lua_State* _luaState, int _index) {
+				if (lua_type(_luaState, _index) != LUA_TTABLE) {
+					return etk::Map<LUAW_KEY, LUAW_VALUE>();
+				}
+				return get(_luaState, _index, false);
+			}
+			static void push(lua_State* _luaState, const etk::Map<LUAW_KEY, LUAW_VALUE>& _value) {
+				lua_createtable(_luaState, 0, int(_value.size())); // ... {}
+				for (auto it = _value.begin(); it != _value.end(); ++it) {
+					luaWrapper::utils::push<LUAW_KEY>(_luaState, it.getKey()); // ... {} key
+					luaWrapper::utils::push<LUAW_VALUE>(_luaState, it.getValue()); // ... {} key value
+					lua_rawset(_luaState, -3); // ... {}
+				}
+			}
+			private:
+				static etk::Map<LUAW_KEY, LUAW_VALUE> get(lua_State* _luaState, int _index, bool _check) {
+					int index = lua_absindex(_luaState, _index);
+					// Count the elements to reserve the map (lua_next does not allocate).
+					size_t size = 0;
+					for (lua_pushnil(_luaState); lua_next(_luaState, index); lua_pop(_luaState, 1)) {
+						++size;
+					}
+					etk::Map<LUAW_KEY, LUAW_VALUE> out(size);
+					for (lua_pushnil(_luaState); lua_next(_luaState, index); lua_pop(_luaState, 1)) {
+						// ... key value
+						// The key is converted on a copy: lua_tostring would change the key used by lua_next.
+						lua_pushvalue(_luaState, -2); // ... key value key
+						if (_check == true) {
+							LUAW_KEY key = luaWrapper::utils::checkElement<LUAW_KEY>(_luaState, index, -3, -1, "key");
+							out.add(etk::move(key), luaWrapper::utils::checkElement<LUAW_VALUE>(_luaState, index, -3, -2, "element"));
+						} else {
+							out.add(luaWrapper::utils::to<LUAW_KEY>(_luaState, -1), luaWrapper::utils::to<LUAW_VALUE>(_luaState, -2));
+						}
+						lua_pop(_luaState, 1); // ... key value
+					}
+					return out;
+				}
+		};
+		
+		/**
+		 * etk::Pair <-> table {first, second}. (Lua::call return an etk::Pair
+		 * from two results, see CallReturn.)
+		 */
+		template<typename LUAW_TYPE, typename LUAW_TYPE2> struct Converter<etk::Pair<LUAW_TYPE, LUAW_TYPE2>> {
+			static etk::Pair<LUAW_TYPE, LUAW_TYPE2> check(lua_State* _luaState, int _index) {
+				luaL_checktype(_luaState, _index, LUA_TTABLE);
+				int index = lua_absindex(_luaState, _index);
+				lua_rawgeti(_luaState, index, 1); // ... first
+				lua_pushinteger(_luaState, 1); // ... first 1
+				lua_rawgeti(_luaState, index, 2); // ... first 1 second
+				lua_pushinteger(_luaState, 2); // ... first 1 second 2
+				etk::Pair<LUAW_TYPE, LUAW_TYPE2> out(luaWrapper::utils::checkElement<LUAW_TYPE>(_luaState, index, -3, -4, "element"),
+				                                     luaWrapper::utils::checkElement<LUAW_TYPE2>(_luaState, index, -1, -2, "element"));
+				lua_pop(_luaState, 4); // ...
+				return out;
+			}
+			static etk::Pair<LUAW_TYPE, LUAW_TYPE2> to(lua_State* _luaState, int _index) {
+				if (lua_type(_luaState, _index) != LUA_TTABLE) {
+					return etk::Pair<LUAW_TYPE, LUAW_TYPE2>();
+				}
+				int index = lua_absindex(_luaState, _index);
+				lua_rawgeti(_luaState, index, 1); // ... first
+				lua_rawgeti(_luaState, index, 2); // ... first second
+				etk::Pair<LUAW_TYPE, LUAW_TYPE2> out(luaWrapper::utils::to<LUAW_TYPE>(_luaState, -2),
+				                                     luaWrapper::utils::to<LUAW_TYPE2>(_luaState, -1));
+				lua_pop(_luaState, 2); // ...
+				return out;
+			}
+			static void push(lua_State* _luaState, const etk::Pair<LUAW_TYPE, LUAW_TYPE2>& _value) {
+				lua_createtable(_luaState, 2, 0); // ... {}
+				luaWrapper::utils::push<LUAW_TYPE>(_luaState, _value.first); // ... {} first
+				lua_rawseti(_luaState, -2, 1); // ... {}
+				luaWrapper::utils::push<LUAW_TYPE2>(_luaState, _value.second); // ... {} second
+				lua_rawseti(_luaState, -2, 2); // ... {}
+			}
+		};
+		
+		template<int... ints> struct IntPack { };
+		template<int start, int count, int... tail> struct MakeIntRangeType {
+			typedef typename MakeIntRangeType<start, count-1, start+count-1, tail...>::type type;
+		};
+		template<int start, int... tail> struct MakeIntRangeType<start, 0, tail...> {
+			typedef IntPack<tail...> type;
+		};
+		template<int start, int count> inline typename MakeIntRangeType<start, count>::type makeIntRange() {
+			return typename MakeIntRangeType<start, count>::type();
+		}
 	}
+	/**
+	 * Describe how the values returned by a lua function are converted in the
+	 * C++ return type of Lua::call and LuaFunction: count is the number of lua
+	 * results and get convert them (the first one is at the index _first).
+	 *
+	 * By default one value is converted with luaWrapper::utils::check. The
+	 * std::tuple and etk::Pair are filled with several results:
+	 *
+	 * std::tuple<float, float, float> pos = lua.call<std::tuple<float, float, float>>("getPosition");
+	 *
+	 * To fill directly your own structure, specialize CallReturn with
+	 * CallReturnStruct (the structure is aggregate initialized in the order of
+	 * the types):
+	 *
+	 * struct Position { float x; float y; float z; };
+	 * template<> struct luaWrapper::CallReturn<Position> : luaWrapper::CallReturnStruct<Position, float, float, float> {};
+	 */
+	template<class LUAW_TYPE>
+	struct CallReturn {
+		static const int32_t count = 1;
+		static LUAW_TYPE get(lua_State* _luaState, int _first) {
+			return luaWrapper::utils::check<LUAW_TYPE>(_luaState, _first);
+		}
+		static LUAW_TYPE pop(lua_State* _luaState) {
+			LUAW_TYPE returnValue = get(_luaState, -count);
+			lua_pop(_luaState, count);
+			return returnValue;
+		}
+	};
+	template<>
+	struct CallReturn<void> {
+		static const int32_t count = 0;
+		static void pop(lua_State* _luaState) {
+			// nothing to do...
+		}
+	};
+	template<class LUAW_TYPE, class ... LUAW_TYPES>
+	struct CallReturnStruct {
+		static const int32_t count = int32_t(sizeof...(LUAW_TYPES));
+		static LUAW_TYPE get(lua_State* _luaState, int _first) {
+			return getImpl(_luaState, _first, luaWrapper::utils::makeIntRange<0, sizeof...(LUAW_TYPES)>());
+		}
+		static LUAW_TYPE pop(lua_State* _luaState) {
+			LUAW_TYPE returnValue = get(_luaState, -count);
+			lua_pop(_luaState, count);
+			return returnValue;
+		}
+		private:
+			template<int... indices>
+			static LUAW_TYPE getImpl(lua_State* _luaState, int _first, luaWrapper::utils::IntPack<indices...>) {
+				return LUAW_TYPE{luaWrapper::utils::check<LUAW_TYPES>(_luaState, _first + indices)...};
+			}
+	};
+	template<class ... LUAW_TYPES>
+	struct CallReturn<std::tuple<LUAW_TYPES...>> : public CallReturnStruct<std::tuple<LUAW_TYPES...>, LUAW_TYPES...> {};
+	template<class LUAW_TYPE, class LUAW_TYPE2>
+	struct CallReturn<etk::Pair<LUAW_TYPE, LUAW_TYPE2>> {
+		static const int32_t count = 2;
+		static etk::Pair<LUAW_TYPE, LUAW_TYPE2> get(lua_State* _luaState, int _first) {
+			return etk::Pair<LUAW_TYPE, LUAW_TYPE2>(luaWrapper::utils::check<LUAW_TYPE>(_luaState, _first),
+			                                        luaWrapper::utils::check<LUAW_TYPE2>(_luaState, _first + 1));
+		}
+		static etk::Pair<LUAW_TYPE, LUAW_TYPE2> pop(lua_State* _luaState) {
+			etk::Pair<LUAW_TYPE, LUAW_TYPE2> returnValue = get(_luaState, -count);
+			lua_pop(_luaState, count);
+			return returnValue;
+		}
+	};
 	// end the recursive template...
 	inline void setCallParameters(lua_State* _luaState) {
 		// nothing to do...
@@ -71,43 +454,306 @@ namespace luaWrapper {
 	}
 	template<class LUAW_ARG, class ... LUAW_ARGS>
 	void setCallParameters(lua_State* _luaState, LUAW_ARG&& _value, LUAW_ARGS&&... _args) {
-		luaWrapper::utils::push<LUAW_ARG>(_luaState, _value);
+		luaWrapper::utils::push<typename std::remove_cv<typename std::remove_reference<LUAW_ARG>::type>::type>(_luaState, _value);
 		setCallParameters(_luaState, etk::forward<LUAW_ARGS>(_args)...);
 	}
+	/**
+	 * Exception thrown when the memory limit of a state is reached (LUA_ERRMEM).
+	 * The state is still usable.
+	 */
+	class MemoryError : public etk::exception::RuntimeError {
+		public:
+			MemoryError(const etk::String& _what) :
+			  etk::exception::RuntimeError(_what) {
+				
+			}
+	};
+	/**
+	 * Call the function under the parameters on the stack, in protected mode.
+	 * @param[in] _luaState Lua state.
+	 * @param[in] _numberParameter Number of parameter on the stack.
+	 * @param[in] _numberReturn Number of value to keep on the stack.
+	 * @param[in] _functionName Name of the function (for the error message).
+	 * @throw luaWrapper::MemoryError The call failed on a memory allocation.
+	 * @throw etk::exception::RuntimeError The call failed (the error message is removed from the stack).
+	 */
+	inline void protectedCall(lua_State* _luaState, int32_t _numberParameter, int32_t _numberReturn, const char* _functionName) {
+		int ret = lua_pcall(_luaState, _numberParameter, _numberReturn, 0);
+		if (ret != 0) {
+			etk::String error = etk::String("error running function `") + _functionName + ": " + lua_tostring(_luaState, -1);
+			lua_pop(_luaState, 1);
+			if (ret == LUA_ERRMEM) {
+				ETK_THROW_EXCEPTION(luaWrapper::MemoryError(error));
+			}
+			ETK_THROW_EXCEPTION(etk::exception::RuntimeError(error));
+		}
+	}
+	/**
+	 * Push on the stack the value of a dotted path (ex: "ai.update" push the
+	 * field "update" of the global table "ai"). Push nil if an element of the
+	 * path does not exist.
+	 * @param[in] _luaState Lua state.
+	 * @param[in] _path Path of the value.
+	 */
+	inline void pushPath(lua_State* _luaState, const etk::String& _path) {
+		size_t start = 0;
+		lua_pushglobaltable(_luaState); // ... table
+		while (start <= _path.size()) {
+			size_t stop = _path.find('.', start);
+			if (stop == etk::String::npos) {
+				stop = _path.size();
+			}
+			if (lua_type(_luaState, -1) != LUA_TTABLE) {
+				lua_pop(_luaState, 1); // ...
+				lua_pushnil(_luaState); // ... nil
+				return;
+			}
+			lua_pushlstring(_luaState, &_path[start], stop - start); // ... table key
+			lua_gettable(_luaState, -2); // ... table value
+			lua_remove(_luaState, -2); // ... value
+			start = stop + 1;
+		}
+	}
+	/**
+	 * @brief Persistent handle on a lua function: the path is resolved one time
+	 * (at the creation) and the function is kept in the registry (luaL_ref), a
+	 * call is a single lua_rawgeti.
+	 * @note The handle must not outlive the state.
+	 *
+	 * luaWrapper::LuaFunction<int(int, float)> update = lua.getFunction<int(int, float)>("ai.update");
+	 * int ret = update(12, 0.5f);
+	 */
+	template<class LUAW_SIGNATURE>
+	class LuaFunction;
+	template<class LUAW_RETURN_TYPE, class ... LUAW_ARGS>
+	class LuaFunction<LUAW_RETURN_TYPE(LUAW_ARGS...)> {
+		private:
+			lua_State* m_luaState = null; //!< State that own the function.
+			int m_reference = LUA_NOREF; //!< Registry reference of the function.
+			etk::String m_name; //!< Path of the function (for the error message).
+		public:
+			LuaFunction() = default;
+			/**
+			 * @brief Resolve a function.
+			 * @param[in] _luaState Lua state.
+			 * @param[in] _path Dotted path of the function (ex: "ai.update").
+			 */
+			LuaFunction(lua_State* _luaState, const etk::String& _path) :
+			  m_luaState(_luaState),
+			  m_name(_path) {
+				pushPath(m_luaState, m_name); // ... function
+				if (lua_type(m_luaState, -1) != LUA_TFUNCTION) {
+					lua_pop(m_luaState, 1); // ...
+					return;
+				}
+				m_reference = luaL_ref(m_luaState, LUA_REGISTRYINDEX); // ...
+			}
+			LuaFunction(const LuaFunction& _obj) :
+			  m_luaState(_obj.m_luaState),
+			  m_name(_obj.m_name) {
+				if (_obj.isValid() == true) {
+					lua_rawgeti(m_luaState, LUA_REGISTRYINDEX, _obj.m_reference); // ... function
+					m_reference = luaL_ref(m_luaState, LUA_REGISTRYINDEX); // ...
+				}
+			}
+			LuaFunction(LuaFunction&& _obj) {
+				etk::swap(m_luaState, _obj.m_luaState);
+				etk::swap(m_reference, _obj.m_reference);
+				etk::swap(m_name, _obj.m_name);
+			}
+			LuaFunction& operator= (const LuaFunction& _obj) {
+				if (this != &_obj) {
+					LuaFunction tmp(_obj);
+					*this = etk::move(tmp);
+				}
+				return *this;
+			}
+			LuaFunction& operator= (LuaFunction&& _obj) {
+				etk::swap(m_luaState, _obj.m_luaState);
+				etk::swap(m_reference, _obj.m_reference);
+				etk::swap(m_name, _obj.m_name);
+				return *this;
+			}
+			~LuaFunction() {
+				if (isValid() == true) {
+					luaL_unref(m_luaState, LUA_REGISTRYINDEX, m_reference);
+				}
+			}
+			/**
+			 * @brief Check if the path has been resolved to a function.
+			 * @return true if the function can be called.
+			 */
+			bool isValid() const {
+				return    m_luaState != null
+				       && m_reference != LUA_NOREF;
+			}
+			/**
+			 * @brief Call the function.
+			 * @param[in] _args... Parameters of the function.
+			 * @return The value(s) returned by the function (see CallReturn).
+			 * @throw etk::exception::RuntimeError The function does not exist or failed.
+			 */
+			LUAW_RETURN_TYPE operator()(LUAW_ARGS... _args) {
+				callGeneric(CallReturn<LUAW_RETURN_TYPE>::count, _args...);
+				return CallReturn<LUAW_RETURN_TYPE>::pop(m_luaState);
+			}
+		private:
+			void callGeneric(int32_t _numberReturn, LUAW_ARGS... _args) {
+				if (isValid() == false) {
+					ETK_THROW_EXCEPTION(etk::exception::RuntimeError(etk::String("error running function `") + m_name + ": function does not exist"));
+				}
+				lua_rawgeti(m_luaState, LUA_REGISTRYINDEX, m_reference); // function
+				setCallParameters(m_luaState, _args...);
+				protectedCall(m_luaState, int32_t(sizeof...(LUAW_ARGS)), _numberReturn, m_name.c_str());
+			}
+	};
+	class BindingContext;
 	/**
 	 * @brief main interface of Lua engine.
 	 */
 	class Lua {
 		private:
 			lua_State* m_luaState = null;
+			etk::String m_bytecodeCachePath; //!< Folder of the bytecode cache (empty: no cache).
+			bool m_bytecodeStripDebug = false; //!< Remove the debug information of the cached bytecode.
+			lua_Alloc m_allocator = null; //!< Allocator given by the user (NULL: system realloc/free).
+			void* m_allocatorData = null; //!< User data of m_allocator.
+			size_t m_memoryLimit = 0; //!< Maximum size of the memory used by the state (0: no limit).
+			std::atomic<size_t> m_memoryUsage; //!< Current size of the memory used by the state (only written by the thread that use the state).
+			std::atomic<size_t> m_memoryPeak; //!< Maximum of m_memoryUsage.
+			ememory::SharedPtr<luaWrapper::AllocationProfiler> m_profiler; //!< Attribution of the allocations (NULL: disabled).
+			luaWrapper::BindingContext* m_context = null; //!< Binding context of the state (only set when the profiling is enabled).
 		public:
-			Lua() {
-				m_luaState = luaL_newstate();
-				if (m_luaState != null) {
-					luaL_openlibs(m_luaState);
-				}
-			}
+			Lua();
+			/**
+			 * Create a state that use a specific allocator (for example
+			 * luaWrapper::PoolAllocator::allocate).
+			 * @param[in] _allocator Allocation function of the state.
+			 * @param[in] _userData Opaque pointer given to the allocator (it must live longer than the state).
+			 */
+			Lua(lua_Alloc _allocator, void* _userData);
+			Lua(const Lua&) = delete;
+			Lua& operator=(const Lua&) = delete;
 			~Lua() {
+				setAllocationProfiling(false);
 				if (m_luaState != null) {
 					lua_close(m_luaState);
 					m_luaState = null;
 				}
 			}
-			void executeFile(const etk::String& _fileName) {
-				etk::String data = etk::FSNodeReadAllData(_fileName);
-				if (luaL_dostring(m_luaState, &data[0])) {
-					LUAW_PRINT(lua_tostring(m_luaState, -1));
-				}
+			/**
+			 * Enable the on-disk bytecode cache of executeFile: the compiled chunks
+			 * are dumped (lua_dump) in the folder, keyed by the hash of the source
+			 * and the lua version, and loaded in binary mode when they are valid.
+			 * The file name is "<source hash>-<lua version>-s.luac" for the
+			 * stripped chunks, and "<source hash>-<chunk name hash>-<lua version>.luac"
+			 * (the debug information contain the chunk name) otherwise.
+			 * @note Lua does not verify the binary chunks: the folder must only be
+			 * writable by trusted users.
+			 * @param[in] _path Folder of the cache (empty to disable the cache).
+			 * @param[in] _stripDebug Remove the debug information (line number, local names) of the cached chunks.
+			 */
+			void setBytecodeCache(const etk::String& _path, bool _stripDebug = false) {
+				m_bytecodeCachePath = _path;
+				m_bytecodeStripDebug = _stripDebug;
 			}
-			void executeString(const etk::String& _rawData) {
-				if (luaL_dostring(m_luaState, &_rawData[0])) {
-					LUAW_PRINT(lua_tostring(m_luaState, -1));
-				}
+			/**
+			 * Execute a script file. The file is streamed to lua_load by fixed
+			 * size blocks (it is never fully copied in memory), with the chunk
+			 * name "@<fileName>".
+			 * @param[in] _fileName Name of the file.
+			 * @throw luaWrapper::MemoryError The memory limit has been reached.
+			 */
+			void executeFile(const etk::String& _fileName);
+			/**
+			 * Execute a script.
+			 * @param[in] _rawData Source of the script.
+			 * @param[in] _chunkName Name of the chunk (in the error messages and debug information).
+			 * @throw luaWrapper::MemoryError The memory limit has been reached.
+			 */
+			void executeString(const etk::String& _rawData, const char* _chunkName = "=string") {
+				executeBuffer(_rawData.c_str(), _rawData.size(), _chunkName);
 			}
+			/**
+			 * Execute a script from a memory buffer (no copy, no strlen).
+			 * Only the source text is accepted: lua does not verify the
+			 * precompiled chunks (a malformed one can corrupt the memory).
+			 * @param[in] _data Source of the script.
+			 * @param[in] _size Size of the source.
+			 * @param[in] _chunkName Name of the chunk (in the error messages and debug information).
+			 * @throw luaWrapper::MemoryError The memory limit has been reached.
+			 */
+			void executeBuffer(const char* _data, size_t _size, const char* _chunkName = "=buffer");
 			lua_State* getState() {
 				return m_luaState;
 			}
+			/**
+			 * Limit the memory used by the state. When an allocation reach the
+			 * limit, it fails: lua run an emergency full GC and try again, then
+			 * raise a memory error (luaWrapper::MemoryError is thrown by the
+			 * executeXXX and call functions, the state stay usable).
+			 * @note An allocation done outside of a protected call (push from
+			 * C++ ...) that reach the limit call the panic function.
+			 * @param[in] _limit Maximum size in bytes (0: no limit).
+			 */
+			void setMemoryLimit(size_t _limit) {
+				m_memoryLimit = _limit;
+			}
+			size_t getMemoryLimit() const {
+				return m_memoryLimit;
+			}
+			/**
+			 * Get the size of the memory used by the state (it can be called from any thread).
+			 */
+			size_t getMemoryUsage() const {
+				return m_memoryUsage.load(std::memory_order_relaxed);
+			}
+			/**
+			 * Get the maximum size of the memory used by the state (it can be called from any thread).
+			 */
+			size_t getMemoryPeak() const {
+				return m_memoryPeak.load(std::memory_order_relaxed);
+			}
+			void resetMemoryPeak() {
+				m_memoryPeak.store(getMemoryUsage(), std::memory_order_relaxed);
+			}
+			/**
+			 * Enable the attribution of the allocations to the script lines and
+			 * the bound types (slow: only to find the allocation hot spots).
+			 * @note The location is tracked with a lua hook (lua_sethook): it
+			 * replaces the hook of the application while the profiling is enabled.
+			 * @param[in] _enable true to start the profiling (the previous results are removed), false to stop it.
+			 */
+			void setAllocationProfiling(bool _enable);
+			/**
+			 * Get the profiler (NULL if the profiling is disabled).
+			 */
+			const luaWrapper::AllocationProfiler* getAllocationProfiler() const {
+				return m_profiler.get();
+			}
+			/**
+			 * Get the report of the allocation sites: live and cumulative bytes and counts, sorted by live size.
+			 */
+			etk::String getAllocationReport() const {
+				if (m_profiler == null) {
+					return "";
+				}
+				return m_profiler->getReport();
+			}
 		private:
+			/**
+			 * lua_Alloc of all the states: count the memory, apply the limit and
+			 * call the user allocator (_userData is the Lua).
+			 */
+			static void* allocate(void* _userData, void* _ptr, size_t _oldSize, size_t _newSize);
+			/**
+			 * Error outside of any protected call (same as the luaL_newstate one).
+			 */
+			static int panic(lua_State* _luaState);
+			/**
+			 * Hook of the allocation profiling: update the location of the profiler.
+			 */
+			static void profilerHook(lua_State* _luaState, lua_Debug* _info);
 			template<class ... LUAW_ARGS>
 			void callGeneric(int32_t _numberReturn, const char* _functionName, LUAW_ARGS&&... _args) {
 				/* push functions and arguments */
@@ -115,25 +761,39 @@ namespace luaWrapper {
 				setCallParameters(m_luaState, etk::forward<LUAW_ARGS>(_args)...);
 				
 				/* do the call (n arguments, 1 result) */
-				if (lua_pcall(m_luaState, int32_t(sizeof...(LUAW_ARGS)), _numberReturn, 0) != 0) {
-					ETK_THROW_EXCEPTION(etk::exception::RuntimeError(etk::String("error running function `") + _functionName +": " + lua_tostring(m_luaState, -1)));
-				}
+				protectedCall(m_luaState, int32_t(sizeof...(LUAW_ARGS)), _numberReturn, _functionName);
 			}
 		public:
+			/**
+			 * Get a persistent handle on a lua function (resolved only one time).
+			 * @param[in] _path Dotted path of the function (ex: "ai.update").
+			 * @return The handle (check LuaFunction::isValid).
+			 */
+			template<class LUAW_SIGNATURE>
+			LuaFunction<LUAW_SIGNATURE> getFunction(const etk::String& _path) {
+				return LuaFunction<LUAW_SIGNATURE>(m_luaState, _path);
+			}
 			/**
 			 * Call a lua function with some generic parameters (with return value).
 			 * @param[in] _functionName Funtion to call.
 			 * @param[in] _args... Multiple argument (what you want).
-			 * @return The specified type.
+			 * @return The specified type (a std::tuple, an etk::Pair or a structure with a CallReturn specialization get multiple results).
 			 */
 			template<class LUAW_RETURN_TYPE, class ... LUAW_ARGS>
 			LUAW_RETURN_TYPE call(const char* _functionName, LUAW_ARGS&&... _args) {
-				callGeneric(1, _functionName, etk::forward<LUAW_ARGS>(_args)...);
-				// retrieve result
-				LUAW_RETURN_TYPE returnValue = luaWrapper::utils::check<LUAW_RETURN_TYPE>(m_luaState, -1);
-				// pop returned value
-				lua_pop(m_luaState, 1);
-				return returnValue;
+				callGeneric(CallReturn<LUAW_RETURN_TYPE>::count, _functionName, etk::forward<LUAW_ARGS>(_args)...);
+				// retrieve result and pop returned values
+				return CallReturn<LUAW_RETURN_TYPE>::pop(m_luaState);
+			}
+			/**
+			 * Call a lua function that return multiple values (ex: return x, y, z).
+			 * @param[in] _functionName Funtion to call.
+			 * @param[in] _args... Multiple argument (what you want).
+			 * @return A tuple with all the values.
+			 */
+			template<class ... LUAW_RETURN_TYPES, class ... LUAW_ARGS>
+			std::tuple<LUAW_RETURN_TYPES...> callMultiple(const char* _functionName, LUAW_ARGS&&... _args) {
+				return call<std::tuple<LUAW_RETURN_TYPES...>>(_functionName, etk::forward<LUAW_ARGS>(_args)...);
 			}
 			/**
 			 * Call a lua function with some generic parameters (WITHOUT return value).
@@ -176,6 +836,27 @@ namespace luaWrapper {
 		lua_pushlightuserdata(_luaState, _obj.get());
 	}
 	
+	/**
+	 * Random secret of the process (initialized on the first use).
+	 */
+	inline uint64_t userdataSecret() {
+		static const uint64_t g_secret = (uint64_t(std::chrono::steady_clock::now().time_since_epoch().count()) * 1099511628211ULL)
+		                                 ^ uint64_t(reinterpret_cast<uintptr_t>(&g_secret));
+		return g_secret;
+	}
+	
+	/**
+	 * Magic stored at the start of the userdata created by LuaWrapper. It
+	 * depends on the address of the userdata and on a secret of the process:
+	 * a foreign userdata (even with a copy of the bytes of a LuaWrapper
+	 * userdata) does not match it, and the check does not touch the stack.
+	 * @param[in] _userdata Address of the userdata.
+	 * @param[in] _kind LUAW_USERDATA_MAGIC or LUAW_VALUE_MAGIC.
+	 */
+	inline uint64_t userdataMagic(const void* _userdata, uint64_t _kind) {
+		return userdataSecret() ^ uint64_t(reinterpret_cast<uintptr_t>(_userdata)) ^ (_kind << 32);
+	}
+	
 	/**
 	 * This class is what is used by LuaWrapper to contain the userdata. data
 	 * stores a pointer to the object itself, and cast is used to cast toward the
@@ -183,68 +864,314 @@ namespace luaWrapper {
 	 * typid to compare types, I use the clever trick of using the cast to compare
 	 * types. Because there is at most one cast per type, I can use it to identify
 	 * when and object is the type I want. This is only used internally.
+	 *
+	 * m_typeId and m_ancestors allow to check the type without the registry:
+	 * m_ancestors point on the list of the type ID the type extends (filled by
+	 * extend). m_magic identify the userdata created by LuaWrapper without
+	 * touching the stack (see userdataMagic).
 	 */
 	struct Userdata {
-		Userdata(ememory::SharedPtr<void> _vptr = null, size_t _typeId = 0):
+		Userdata(ememory::SharedPtr<void> _vptr = null, size_t _typeId = 0, const etk::Vector<size_t>* _ancestors = null):
+		  m_magic(userdataMagic(this, LUAW_USERDATA_MAGIC)),
 		  m_data(etk::move(_vptr)),
-		  m_typeId(_typeId) {
+		  m_pointer(m_data.get()),
+		  m_generationCounter(null),
+		  m_generation(0),
+		  m_typeId(_typeId),
+		  m_ancestors(_ancestors) {
+			// nothing to do ...
+		}
+		Userdata(void* _pointer, const uint32_t* _generationCounter, size_t _typeId, const etk::Vector<size_t>* _ancestors):
+		  m_magic(userdataMagic(this, LUAW_USERDATA_MAGIC)),
+		  m_data(null),
+		  m_pointer(_pointer),
+		  m_generationCounter(_generationCounter),
+		  m_generation(*_generationCounter),
+		  m_typeId(_typeId),
+		  m_ancestors(_ancestors) {
 			// nothing to do ...
 		}
 		Userdata(Userdata&& _obj) {
+			m_magic = userdataMagic(this, LUAW_USERDATA_MAGIC);
 			etk::swap(m_data, _obj.m_data);
+			etk::swap(m_pointer, _obj.m_pointer);
+			etk::swap(m_generationCounter, _obj.m_generationCounter);
+			etk::swap(m_generation, _obj.m_generation);
 			etk::swap(m_typeId, _obj.m_typeId);
+			etk::swap(m_ancestors, _obj.m_ancestors);
 		}
 		Userdata(const Userdata& _obj) {
+			m_magic = userdataMagic(this, LUAW_USERDATA_MAGIC);
 			m_data = _obj.m_data;
+			m_pointer = _obj.m_pointer;
+			m_generationCounter = _obj.m_generationCounter;
+			m_generation = _obj.m_generation;
 			m_typeId = _obj.m_typeId;
+			m_ancestors = _obj.m_ancestors;
 		}
 		Userdata& operator= (Userdata&& _obj) {
 			etk::swap(m_data, _obj.m_data);
+			etk::swap(m_pointer, _obj.m_pointer);
+			etk::swap(m_generationCounter, _obj.m_generationCounter);
+			etk::swap(m_generation, _obj.m_generation);
 			etk::swap(m_typeId, _obj.m_typeId);
+			etk::swap(m_ancestors, _obj.m_ancestors);
 			return *this;
 		}
 		Userdata& operator= (const Userdata& _obj) {
 			m_data = _obj.m_data;
+			m_pointer = _obj.m_pointer;
+			m_generationCounter = _obj.m_generationCounter;
+			m_generation = _obj.m_generation;
 			m_typeId = _obj.m_typeId;
+			m_ancestors = _obj.m_ancestors;
 			return *this;
 		}
-		ememory::SharedPtr<void> m_data;
+		/**
+		 * A borrowed object (pushBorrowed) is not owned by the userdata.
+		 */
+		bool isBorrowed() const {
+			return m_generationCounter != null;
+		}
+		/**
+		 * Get the object, or NULL if the borrowed object has been destroyed
+		 * (its generation counter changed since the push).
+		 */
+		void* get() const {
+			if (    m_generationCounter != null
+			     && *m_generationCounter != m_generation) {
+				return null;
+			}
+			return m_pointer;
+		}
+		uint64_t m_magic; //!< userdataMagic(this, LUAW_USERDATA_MAGIC) (0 when destroyed)
+		ememory::SharedPtr<void> m_data; //!< owner of the object (NULL for a borrowed object)
+		void* m_pointer; //!< the object (m_data.get() or the borrowed pointer)
+		const uint32_t* m_generationCounter; //!< generation counter of a borrowed object (NULL if the object is owned)
+		uint32_t m_generation; //!< value of *m_generationCounter when the object has been pushed
 		size_t m_typeId;
+		const etk::Vector<size_t>* m_ancestors;
+	};
+	
+	/**
+	 * Get the LuaWrapper userdata at the given index, or NULL if the value is
+	 * not a userdata created by LuaWrapper (checked with the magic, without
+	 * touching the stack).
+	 */
+	inline Userdata* getUserdata(lua_State* _luaState, int _index) {
+		if (    lua_type(_luaState, _index) != LUA_TUSERDATA
+		     || lua_rawlen(_luaState, _index) < sizeof(Userdata)) {
+			return null;
+		}
+		Userdata* pud = static_cast<Userdata*>(lua_touserdata(_luaState, _index));
+		if (pud->m_magic != userdataMagic(pud, LUAW_USERDATA_MAGIC)) {
+			return null;
+		}
+		return pud;
+	}
+	
+	/**
+	 * Signatures of the per-type functions given to setfuncs.
+	 */
+	template <typename LUAW_TYPE>
+	class TypeFunction {
+		public:
+			typedef void (*Identifier)(lua_State*, ememory::SharedPtr<LUAW_TYPE>);
+			typedef ememory::SharedPtr<LUAW_TYPE> (*Allocator)(lua_State*);
+		private:
+			TypeFunction();
 	};
 	
 	/**
-	 * This class cannot actually to be instantiated. It is used only hold the
-	 * table name and other information.
+	 * Each registered type get a dense index (process wide), used to find its
+	 * binding in the per-state context without any string hashing.
 	 */
+	inline size_t nextTypeIndex() {
+		static std::atomic<size_t> g_typeIndex(0);
+		return g_typeIndex++;
+	}
 	template <typename LUAW_TYPE>
-	class LuaWrapper {
+	size_t typeIndex() {
+		static size_t g_index = nextTypeIndex();
+		return g_index;
+	}
+	
+	/**
+	 * Registration of a type in a state: registry references (luaL_ref) of the
+	 * per-type tables (they replace the "LuaWrapper.<field>.<classname>" lookups
+	 * on the hot paths) and the functions given to setfuncs/extend.
+	 *
+	 * Each state has its own bindings: the same C++ type can be registered with
+	 * different names, allocators or identifiers in two states, and the states
+	 * can be used (and registered) in different threads without any lock.
+	 */
+	struct TypeBinding {
+		int m_cache = LUA_NOREF; //!< weak table: identifier -> userdata
+		int m_holds = LUA_NOREF; //!< table: identifier -> true if Lua own the object
+		int m_metatable = LUA_NOREF; //!< metatable of the type
+		const char* m_classname = null; //!< name of the type (NULL if the type is not registered)
+		void (*m_identifier)() = null; //!< TypeFunction<T>::Identifier (the type is erased to be stored here)
+		void (*m_allocator)() = null; //!< TypeFunction<T>::Allocator (the type is erased to be stored here)
+		void (*m_postconstructorrecurse)(lua_State*, int) = null; //!< postconstructorinternal of the parent type
+		bool m_sealed = false; //!< no per-object storage (see seal)
+		etk::Vector<size_t> m_ancestors; //!< type ID of all the types T inherit from (see extend)
+	};
+	
+	/**
+	 * Per-state C++ data of LuaWrapper. It lives in a userdata stored in the
+	 * registry (key: bindingContextKey) and is destroyed with the state.
+	 *
+	 * This class is only used internally.
+	 */
+	class BindingContext {
+		private:
+			//! Binding of each type (index: typeIndex<T>()). They are allocated
+			//! one by one: a reference on a binding stay valid when the list grows.
+			etk::Vector<ememory::SharedPtr<TypeBinding>> m_types;
 		public:
-			static const char* classname;
-			static void (*identifier)(lua_State*, ememory::SharedPtr<LUAW_TYPE>);
-			static ememory::SharedPtr<LUAW_TYPE> (*allocator)(lua_State*);
-			static void (*postconstructorrecurse)(lua_State* _luaState, int numargs);
+			//! Name of the type pushed/created, read by the allocation profiler
+			//! (set with AllocationScope).
+			const char* m_allocationScope = null;
+			//! Profiler of the state, updated by the hook of Lua::setAllocationProfiling (NULL: disabled).
+			luaWrapper::AllocationProfiler* m_profiler = null;
+			TypeBinding& get(size_t _typeIndex) {
+				if (_typeIndex >= m_types.size()) {
+					m_types.resize(_typeIndex + 1);
+				}
+				if (m_types[_typeIndex] == null) {
+					m_types[_typeIndex] = ememory::makeShared<TypeBinding>();
+				}
+				return *m_types[_typeIndex];
+			}
+	};
+	
+	/**
+	 * Set the allocation scope of a context for the life of the object. A lua
+	 * error thrown as a C++ exception restores it. With a longjmp (lua built
+	 * as C), the hook of the profiler clears it at the next event of the
+	 * script (no push or create is running when a lua function runs).
+	 */
+	class AllocationScope {
 		private:
-			LuaWrapper();
+			BindingContext* m_context;
+			const char* m_previous;
+		public:
+			AllocationScope(BindingContext* _context, const char* _scope) :
+			  m_context(_context),
+			  m_previous(_context->m_allocationScope) {
+				m_context->m_allocationScope = _scope;
+			}
+			~AllocationScope() {
+				m_context->m_allocationScope = m_previous;
+			}
+			AllocationScope(const AllocationScope&) = delete;
+			AllocationScope& operator=(const AllocationScope&) = delete;
 	};
-	template <typename LUAW_TYPE> const char* LuaWrapper<LUAW_TYPE>::classname;
-	template <typename LUAW_TYPE> void (*LuaWrapper<LUAW_TYPE>::identifier)(lua_State*, ememory::SharedPtr<LUAW_TYPE>);
-	template <typename LUAW_TYPE> ememory::SharedPtr<LUAW_TYPE> (*LuaWrapper<LUAW_TYPE>::allocator)(lua_State*);
-	template <typename LUAW_TYPE> void (*LuaWrapper<LUAW_TYPE>::postconstructorrecurse)(lua_State* _luaState, int _numargs);
+	
+	/**
+	 * The address of this variable is the registry key of the BindingContext.
+	 */
+	inline const void* bindingContextKey() {
+		static const char g_key = 0;
+		return &g_key;
+	}
+	
+	inline void initialize(lua_State* _luaState);
+	
+	/**
+	 * Get the binding context of the state. It is created (initialize) on a
+	 * state where no type has been registered: the types are then reported as
+	 * not registered.
+	 */
+	inline BindingContext* getContext(lua_State* _luaState) {
+		lua_rawgetp(_luaState, LUA_REGISTRYINDEX, bindingContextKey()); // ... ctx
+		BindingContext* context = static_cast<BindingContext*>(lua_touserdata(_luaState, -1));
+		lua_pop(_luaState, 1); // ...
+		if (context == null) {
+			initialize(_luaState);
+			lua_rawgetp(_luaState, LUA_REGISTRYINDEX, bindingContextKey()); // ... ctx
+			context = static_cast<BindingContext*>(lua_touserdata(_luaState, -1));
+			lua_pop(_luaState, 1); // ...
+		}
+		return context;
+	}
+	
+	template <typename LUAW_TYPE>
+	inline TypeBinding& getBinding(lua_State* _luaState) {
+		return getContext(_luaState)->get(typeIndex<LUAW_TYPE>());
+	}
+	
+	/**
+	 * Get the name of the type in the state (NULL if it is not registered).
+	 */
+	template <typename LUAW_TYPE>
+	inline const char* getClassname(lua_State* _luaState) {
+		return getBinding<LUAW_TYPE>(_luaState).m_classname;
+	}
+	
+	/**
+	 * Push the identifier of an object (with the identifier function registered
+	 * for the type in this state).
+	 */
+	template <typename LUAW_TYPE>
+	inline void pushIdentifier(lua_State* _luaState, const TypeBinding& _binding, const ememory::SharedPtr<LUAW_TYPE>& _obj) {
+		if (_binding.m_identifier == null) {
+			luaL_error(_luaState, "attempting to use a type that has not been registered in this state");
+		}
+		reinterpret_cast<typename TypeFunction<LUAW_TYPE>::Identifier>(_binding.m_identifier)(_luaState, _obj);
+	}
+	template <typename LUAW_TYPE>
+	inline void pushIdentifier(lua_State* _luaState, const ememory::SharedPtr<LUAW_TYPE>& _obj) {
+		pushIdentifier<LUAW_TYPE>(_luaState, getBinding<LUAW_TYPE>(_luaState), _obj);
+	}
 	
 	template <typename LUAW_TYPE, typename LUAW_TYPE2>
-	void identify(lua_State* _luaState, LUAW_TYPE* _obj) {
-		LuaWrapper<LUAW_TYPE2>::identifier(_luaState, static_cast<LUAW_TYPE2*>(_obj));
+	void identify(lua_State* _luaState, ememory::SharedPtr<LUAW_TYPE> _obj) {
+		pushIdentifier<LUAW_TYPE2>(_luaState, ememory::staticPointerCast<LUAW_TYPE2>(_obj));
 	}
 	
 	template <typename LUAW_TYPE>
 	inline void wrapperField(lua_State* _luaState, const char* _field) {
 		lua_getfield(_luaState, LUA_REGISTRYINDEX, LUAW_WRAPPER_KEY); // ... LuaWrapper
 		lua_getfield(_luaState, -1, _field); // ... LuaWrapper LuaWrapper.field
-		lua_getfield(_luaState, -1, LuaWrapper<LUAW_TYPE>::classname); // ... LuaWrapper LuaWrapper.field LuaWrapper.field.class
+		lua_getfield(_luaState, -1, getClassname<LUAW_TYPE>(_luaState)); // ... LuaWrapper LuaWrapper.field LuaWrapper.field.class
 		lua_replace(_luaState, -3); // ... LuaWrapper.field.class LuaWrapper.field
 		lua_pop(_luaState, 1); // ... LuaWrapper.field.class
 	}
 	
+	/**
+	 * Returns the userdata at the given acceptable index if it is of type T (or
+	 * if strict is false, convertable to type T) and NULL otherwise.
+	 *
+	 * The userdata created by LuaWrapper are checked with their type ID and the
+	 * ancestors list built by extend, without touching the stack or the
+	 * registry. A foreign userdata (or a userdata already destroyed by its __gc)
+	 * is never of type T.
+	 *
+	 * This function is only called from LuaWrapper internally.
+	 */
+	template <typename LUAW_TYPE>
+	Userdata* toUserdata(lua_State *_luaState, int _index, bool _strict = false) {
+		Userdata* pud = getUserdata(_luaState, _index);
+		if (pud == null) {
+			return null;
+		}
+		size_t typeId = ETK_GET_TYPE_ID(LUAW_TYPE);
+		if (pud->m_typeId == typeId) {
+			return pud;
+		}
+		if (    _strict == true
+		     || pud->m_ancestors == null) {
+			return null;
+		}
+		for (auto &it: *pud->m_ancestors) {
+			if (it == typeId) {
+				return pud;
+			}
+		}
+		return null;
+	}
+	
 	/**
 	 * Analogous to lua_is(boolean|string|*)
 	 *
@@ -253,28 +1180,7 @@ namespace luaWrapper {
 	 */
 	template <typename LUAW_TYPE>
 	bool is(lua_State *_luaState, int _index, bool _strict = false) {
-		bool equal = false;// lua_isnil(_luaState, index);
-		if (    equal == false
-		     && lua_isuserdata(_luaState, _index)
-		     && lua_getmetatable(_luaState, _index)) {
-			// ... ud ... udmt
-			luaL_getmetatable(_luaState, LuaWrapper<LUAW_TYPE>::classname); // ... ud ... udmt Tmt
-			equal = lua_rawequal(_luaState, -1, -2) != 0;
-			if (!equal && !_strict) {
-				lua_getfield(_luaState, -2, LUAW_EXTENDS_KEY); // ... ud ... udmt Tmt udmt.extends
-				for (lua_pushnil(_luaState); lua_next(_luaState, -2); lua_pop(_luaState, 1)) {
-					// ... ud ... udmt Tmt udmt.extends k v
-					equal = lua_rawequal(_luaState, -1, -4) != 0;
-					if (equal) {
-						lua_pop(_luaState, 2); // ... ud ... udmt Tmt udmt.extends
-						break;
-					}
-				}
-				lua_pop(_luaState, 1); // ... ud ... udmt Tmt
-			}
-			lua_pop(_luaState, 2); // ... ud ...
-		}
-		return equal;
+		return toUserdata<LUAW_TYPE>(_luaState, _index, _strict) != null;
 	}
 	
 	/**
@@ -285,8 +1191,8 @@ namespace luaWrapper {
 	 */
 	template <typename LUAW_TYPE>
 	ememory::SharedPtr<LUAW_TYPE> to(lua_State* _luaState, int _index, bool _strict = false) {
-		if (is<LUAW_TYPE>(_luaState, _index, _strict)) {
-			Userdata* pud = static_cast<Userdata*>(lua_touserdata(_luaState, _index));
+		Userdata* pud = toUserdata<LUAW_TYPE>(_luaState, _index, _strict);
+		if (pud != null) {
 			return ememory::staticPointerCast<LUAW_TYPE>(pud->m_data);
 		}
 		return null;
@@ -303,11 +1209,15 @@ namespace luaWrapper {
 	                                         int _index,
 	                                         bool _strict = false) {
 		ememory::SharedPtr<LUAW_TYPE> obj;
-		if (is<LUAW_TYPE>(_luaState, _index, _strict)) {
-			Userdata* pud = static_cast<Userdata*>(lua_touserdata(_luaState, _index));
+		Userdata* pud = toUserdata<LUAW_TYPE>(_luaState, _index, _strict);
+		if (pud != null) {
+			if (pud->isBorrowed() == true) {
+				luaL_argerror(_luaState, _index, "borrowed object can not be shared (use checkRef)");
+			}
 			obj = ememory::staticPointerCast<LUAW_TYPE>(pud->m_data);
 		} else {
-			const char *msg = lua_pushfstring(_luaState, "%s expected, got %s", LuaWrapper<LUAW_TYPE>::classname, luaL_typename(_luaState, _index));
+			const char* classname = getClassname<LUAW_TYPE>(_luaState);
+			const char *msg = lua_pushfstring(_luaState, "%s expected, got %s", classname != null ? classname : "userdata", luaL_typename(_luaState, _index));
 			luaL_argerror(_luaState, _index, msg);
 		}
 		return obj;
@@ -324,32 +1234,105 @@ namespace luaWrapper {
 			return check<LUAW_TYPE>(_luaState, _index, _strict);
 		}
 	}
-	
+
+	/**
+	 * Borrowed version of to: returns the raw pointer of the object without
+	 * copying the SharedPtr (no atomic increment/decrement of the counter).
+	 *
+	 * The pointer is valid as long as the userdata is on the stack (i.e. for the
+	 * duration of the C function that receive it as argument). Use to<T> to keep
+	 * the object after the return of the function. It is also the only access
+	 * to the objects pushed with pushBorrowed (NULL if the object is destroyed).
+	 */
+	template <typename LUAW_TYPE>
+	LUAW_TYPE* toPointer(lua_State* _luaState, int _index, bool _strict = false) {
+		Userdata* pud = toUserdata<LUAW_TYPE>(_luaState, _index, _strict);
+		if (pud != null) {
+			return static_cast<LUAW_TYPE*>(pud->get());
+		}
+		return null;
+	}
+
+	/**
+	 * Borrowed version of check: returns a reference on the object. An error is
+	 * raised if the value is not of (or convertable to) type T, or if it does
+	 * not hold an object anymore (released).
+	 *
+	 * Same life time as toPointer: do not keep the reference after the return
+	 * of the C function. A borrowed object that has been destroyed (see
+	 * pushBorrowed) raises an error instead of a use after free.
+	 */
+	template <typename LUAW_TYPE>
+	LUAW_TYPE& checkRef(lua_State* _luaState,
+	                    int _index,
+	                    bool _strict = false) {
+		Userdata* pud = toUserdata<LUAW_TYPE>(_luaState, _index, _strict);
+		LUAW_TYPE* obj = null;
+		if (pud != null) {
+			obj = static_cast<LUAW_TYPE*>(pud->get());
+		}
+		if (obj == null) {
+			const char* classname = getClassname<LUAW_TYPE>(_luaState);
+			const char *msg = null;
+			if (pud != null) {
+				msg = lua_pushfstring(_luaState, "%s object has been destroyed", classname != null ? classname : "userdata");
+			} else {
+				msg = lua_pushfstring(_luaState, "%s expected, got %s", classname != null ? classname : "userdata", luaL_typename(_luaState, _index));
+			}
+			luaL_argerror(_luaState, _index, msg);
+		}
+		return *obj;
+	}
+
+	/**
+	 * Borrowed version of opt: returns NULL if the value is nil.
+	 */
+	template <typename LUAW_TYPE>
+	LUAW_TYPE* optPointer(lua_State* _luaState,
+	                      int _index,
+	                      bool _strict = false) {
+		if (lua_isnil(_luaState, _index) == true) {
+			return null;
+		}
+		return &checkRef<LUAW_TYPE>(_luaState, _index, _strict);
+	}
+
 	/**
 	 * Analogous to lua_push(boolean|string|*)
 	 *
 	 * Pushes a userdata of type T onto the stack. If this object already exists in
-	 * the Lua environment, it will assign the existing storage table to it.
-	 * Otherwise, a new storage table will be created for it.
+	 * the Lua environment, the existing userdata (with its storage table) is
+	 * pushed. Otherwise, a new userdata will be created for it.
 	 */
 	template <typename LUAW_TYPE>
 	void push(lua_State* _luaState,
 	               ememory::SharedPtr<LUAW_TYPE> _obj) {
 		if (_obj != null) {
-			LuaWrapper<LUAW_TYPE>::identifier(_luaState, _obj); // ... id
-			wrapperField<LUAW_TYPE>(_luaState, LUAW_CACHE_KEY); // ... id cache
+			BindingContext* context = getContext(_luaState);
+			TypeBinding& binding = context->get(typeIndex<LUAW_TYPE>());
+			if (binding.m_metatable == LUA_NOREF) {
+				luaL_error(_luaState, "attempting to use a type that has not been registered in this state");
+			}
+			pushIdentifier<LUAW_TYPE>(_luaState, binding, _obj); // ... id
+			lua_rawgeti(_luaState, LUA_REGISTRYINDEX, binding.m_cache); // ... id cache
 			lua_pushvalue(_luaState, -2); // ... id cache id
 			lua_gettable(_luaState, -2); // ... id cache obj
-			if (lua_isnil(_luaState, -1)) {
+			// A borrowed userdata (pushBorrowed) of an old object at the same
+			// address is replaced: it does not own _obj. A userdata destroyed by a
+			// script calling its __gc is replaced too.
+			Userdata* cached = getUserdata(_luaState, -1);
+			if (    cached == null
+			     || cached->isBorrowed() == true) {
 				// Create the new userdata and place it in the cache
+				AllocationScope scope(context, binding.m_classname);
 				lua_pop(_luaState, 1); // ... id cache
 				lua_insert(_luaState, -2); // ... cache id
 				// placement new creation (need to initilaize the sructure:
-				Userdata* ud = new ((char*)lua_newuserdata(_luaState, sizeof(Userdata))) Userdata(_obj, ETK_GET_TYPE_ID(LUAW_TYPE)); // ... cache id obj
+				Userdata* ud = new ((char*)lua_newuserdata(_luaState, sizeof(Userdata))) Userdata(_obj, ETK_GET_TYPE_ID(LUAW_TYPE), &binding.m_ancestors); // ... cache id obj
 				lua_pushvalue(_luaState, -1); // ... cache id obj obj
 				lua_insert(_luaState, -4); // ... obj cache id obj
 				lua_settable(_luaState, -3); // ... obj cache
-				luaL_getmetatable(_luaState, LuaWrapper<LUAW_TYPE>::classname); // ... obj cache mt
+				lua_rawgeti(_luaState, LUA_REGISTRYINDEX, binding.m_metatable); // ... obj cache mt
 				lua_setmetatable(_luaState, -3); // ... obj cache
 				lua_pop(_luaState, 1); // ... obj
 			} else {
@@ -360,7 +1343,58 @@ namespace luaWrapper {
 			lua_pushnil(_luaState);
 		}
 	}
-	
+
+	/**
+	 * Pushes a userdata of type T that does not own the object (no SharedPtr):
+	 * the object is owned by the application (ex: in the pool of an engine) and
+	 * can be destroyed while lua still reference it.
+	 *
+	 * _generationCounter point on a counter that the application increments
+	 * when the object is destroyed (ex: the generation of the slot of the
+	 * pool). It must stay valid for the life of the state. The value at the
+	 * push is stored in the userdata and checked at each access (checkRef,
+	 * toPointer): a destroyed object raises a lua error instead of a use after
+	 * free. Pushing the same object (same generation) gives the same userdata.
+	 *
+	 * A borrowed object is identified by its address, can not be held, and can
+	 * not be converted in a SharedPtr (to<T> returns NULL, check<T> raises an
+	 * error). The fields set from lua are lost with the userdata of the old
+	 * generation.
+	 */
+	template <typename LUAW_TYPE>
+	void pushBorrowed(lua_State* _luaState,
+	                  LUAW_TYPE* _obj,
+	                  const uint32_t* _generationCounter) {
+		if (_obj == null) {
+			lua_pushnil(_luaState);
+			return;
+		}
+		BindingContext* context = getContext(_luaState);
+		TypeBinding& binding = context->get(typeIndex<LUAW_TYPE>());
+		if (binding.m_metatable == LUA_NOREF) {
+			luaL_error(_luaState, "attempting to use a type that has not been registered in this state");
+		}
+		lua_rawgeti(_luaState, LUA_REGISTRYINDEX, binding.m_cache); // ... cache
+		lua_rawgetp(_luaState, -1, _obj); // ... cache obj
+		Userdata* pud = getUserdata(_luaState, -1);
+		if (    pud != null
+		     && pud->m_pointer == _obj
+		     && pud->m_generationCounter == _generationCounter
+		     && pud->m_generation == *_generationCounter) {
+			lua_replace(_luaState, -2); // ... obj
+			return;
+		}
+		// Not pushed yet, or an old object at the same address.
+		lua_pop(_luaState, 1); // ... cache
+		AllocationScope scope(context, binding.m_classname);
+		new ((char*)lua_newuserdata(_luaState, sizeof(Userdata))) Userdata(_obj, _generationCounter, ETK_GET_TYPE_ID(LUAW_TYPE), &binding.m_ancestors); // ... cache obj
+		lua_rawgeti(_luaState, LUA_REGISTRYINDEX, binding.m_metatable); // ... cache obj mt
+		lua_setmetatable(_luaState, -2); // ... cache obj
+		lua_pushvalue(_luaState, -1); // ... cache obj obj
+		lua_rawsetp(_luaState, -3, _obj); // ... cache obj
+		lua_replace(_luaState, -2); // ... obj
+	}
+
 	/**
 	 * Instructs LuaWrapper that it owns the userdata, and can manage its memory.
 	 * When all references to the object are removed, Lua is free to garbage
@@ -372,8 +1406,9 @@ namespace luaWrapper {
 	template <typename LUAW_TYPE>
 	bool hold(lua_State* _luaState,
 	               ememory::SharedPtr<LUAW_TYPE> _obj) {
-		wrapperField<LUAW_TYPE>(_luaState, LUAW_HOLDS_KEY); // ... holds
-		LuaWrapper<LUAW_TYPE>::identifier(_luaState, _obj); // ... holds id
+		TypeBinding& binding = getBinding<LUAW_TYPE>(_luaState);
+		lua_rawgeti(_luaState, LUA_REGISTRYINDEX, binding.m_holds); // ... holds
+		pushIdentifier<LUAW_TYPE>(_luaState, binding, _obj); // ... holds id
 		lua_pushvalue(_luaState, -1); // ... holds id id
 		lua_gettable(_luaState, -3); // ... holds id hold
 		// If it's not held, hold it
@@ -402,7 +1437,7 @@ namespace luaWrapper {
 	template <typename LUAW_TYPE>
 	void release(lua_State* _luaState,
 	                  int _index) {
-		wrapperField<LUAW_TYPE>(_luaState, LUAW_HOLDS_KEY); // ... id ... holds
+		lua_rawgeti(_luaState, LUA_REGISTRYINDEX, getBinding<LUAW_TYPE>(_luaState).m_holds); // ... id ... holds
 		lua_pushvalue(_luaState, correctindex(_luaState, _index, 1)); // ... id ... holds id
 		lua_pushnil(_luaState); // ... id ... holds id nil
 		lua_settable(_luaState, -3); // ... id ... holds
@@ -412,7 +1447,7 @@ namespace luaWrapper {
 	template <typename LUAW_TYPE>
 	void release(lua_State* _luaState,
 	                  LUAW_TYPE* _obj) {
-		LuaWrapper<LUAW_TYPE>::identifier(_luaState, _obj); // ... id
+		pushIdentifier<LUAW_TYPE>(_luaState, _obj); // ... id
 		release<LUAW_TYPE>(_luaState, -1); // ... id
 		lua_pop(_luaState, 1); // ...
 	}
@@ -421,10 +1456,11 @@ namespace luaWrapper {
 	void postconstructorinternal(lua_State* _luaState,
 	                                  int _numargs) {
 		// ... ud args...
-		if (LuaWrapper<LUAW_TYPE>::postconstructorrecurse) {
-			LuaWrapper<LUAW_TYPE>::postconstructorrecurse(_luaState, _numargs);
+		TypeBinding& binding = getBinding<LUAW_TYPE>(_luaState);
+		if (binding.m_postconstructorrecurse) {
+			binding.m_postconstructorrecurse(_luaState, _numargs);
 		}
-		luaL_getmetatable(_luaState, LuaWrapper<LUAW_TYPE>::classname); // ... ud args... mt
+		lua_rawgeti(_luaState, LUA_REGISTRYINDEX, binding.m_metatable); // ... ud args... mt
 		lua_getfield(_luaState, -1, LUAW_POSTCTOR_KEY); // ... ud args... mt postctor
 		if (lua_type(_luaState, -1) == LUA_TFUNCTION) {
 			for (int i = 0; i < _numargs + 1; i++) {
@@ -464,9 +1500,17 @@ namespace luaWrapper {
 	template <typename LUAW_TYPE>
 	inline int create(lua_State* _luaState, int _numargs) {
 		// ... args...
-		ememory::SharedPtr<LUAW_TYPE> obj = LuaWrapper<LUAW_TYPE>::allocator(_luaState);
-		push<LUAW_TYPE>(_luaState, obj); // ... args... ud
-		hold<LUAW_TYPE>(_luaState, obj);
+		BindingContext* context = getContext(_luaState);
+		TypeBinding& binding = context->get(typeIndex<LUAW_TYPE>());
+		if (binding.m_allocator == null) {
+			return luaL_error(_luaState, "attempting to create a type that has not been registered in this state");
+		}
+		ememory::SharedPtr<LUAW_TYPE> obj = reinterpret_cast<typename TypeFunction<LUAW_TYPE>::Allocator>(binding.m_allocator)(_luaState);
+		{
+			AllocationScope scope(context, binding.m_classname);
+			push<LUAW_TYPE>(_luaState, obj); // ... args... ud
+			hold<LUAW_TYPE>(_luaState, obj);
+		}
 		lua_insert(_luaState, -1 - _numargs); // ... ud args...
 		postconstructor<LUAW_TYPE>(_luaState, _numargs); // ... ud
 		return 1;
@@ -477,35 +1521,104 @@ namespace luaWrapper {
 		return create<LUAW_TYPE>(_luaState, lua_gettop(_luaState));
 	}
 	
+	/**
+	 * Property of a type (see setProperties): the getter and the setter are
+	 * the functions of luaWrapper::utils::get/set (object at index 1, value at
+	 * index 2). A NULL setter makes the property read-only.
+	 */
+	struct Property {
+		const char* name;
+		lua_CFunction getter;
+		lua_CFunction setter;
+	};
+	
+	/**
+	 * Call the getter of the property "key" if the type has one.
+	 *
+	 * This function is only called from LuaWrapper internally.
+	 * @return true if the key is a property (its value is on the top of the stack).
+	 */
+	inline bool getProperty(lua_State* _luaState) {
+		// obj key mt
+		if (lua_getfield(_luaState, 3, LUAW_GETTERS_KEY) != LUA_TTABLE) {
+			lua_pop(_luaState, 1); // obj key mt
+			return false;
+		}
+		// obj key mt getters
+		lua_pushvalue(_luaState, 2); // obj key mt getters key
+		lua_CFunction getter = lua_rawget(_luaState, -2) == LUA_TFUNCTION ? lua_tocfunction(_luaState, -1) : null;
+		if (getter == null) {
+			lua_settop(_luaState, 3); // obj key mt
+			return false;
+		}
+		// The getter is called directly (no lua_call), it push the value.
+		lua_settop(_luaState, 1); // obj
+		getter(_luaState); // obj value
+		return true;
+	}
+	
+	/**
+	 * Call the setter of the property "key" if the type has one (raise an
+	 * error if the property is read-only).
+	 *
+	 * This function is only called from LuaWrapper internally.
+	 * @return true if the key is a property.
+	 */
+	inline bool setProperty(lua_State* _luaState) {
+		// obj key value mt
+		if (lua_getfield(_luaState, 4, LUAW_SETTERS_KEY) != LUA_TTABLE) {
+			lua_pop(_luaState, 1); // obj key value mt
+			return false;
+		}
+		// obj key value mt setters
+		lua_pushvalue(_luaState, 2); // obj key value mt setters key
+		int type = lua_rawget(_luaState, -2); // obj key value mt setters setter
+		if (type == LUA_TFUNCTION) {
+			lua_CFunction setter = lua_tocfunction(_luaState, -1);
+			lua_settop(_luaState, 3); // obj key value
+			lua_remove(_luaState, 2); // obj value
+			setter(_luaState);
+			return true;
+		}
+		if (type == LUA_TBOOLEAN) {
+			luaL_error(_luaState, "property '%s' is read-only", lua_tostring(_luaState, 2));
+		}
+		lua_settop(_luaState, 4); // obj key value mt
+		return false;
+	}
+	
 	/**
 	 * This function is called from Lua, not C++
 	 *
 	 * The default metamethod to call when indexing into lua userdata representing
-	 * an object of type T. This will first check the userdata's environment table
-	 * and if it's not found there it will check the metatable. This is done so
-	 * individual userdata can be treated as a table, and can hold thier own
-	 * values.
+	 * an object of type T. This will first check the properties of the type,
+	 * then the userdata's storage table (its user value) and if it's not found
+	 * there it will check the metatable. This is done so individual userdata can
+	 * be treated as a table, and can hold thier own values.
 	 */
 	template <typename LUAW_TYPE>
 	int index(lua_State* _luaState) {
 		// obj key
-		ememory::SharedPtr<LUAW_TYPE> obj = to<LUAW_TYPE>(_luaState, 1);
-		wrapperField<LUAW_TYPE>(_luaState, LUAW_STORAGE_KEY); // obj key storage
-		LuaWrapper<LUAW_TYPE>::identifier(_luaState, obj); // obj key storage id
-		lua_gettable(_luaState, -2); // obj key storage store
-		// Check if storage table exists
-		if (!lua_isnil(_luaState, -1)) {
-			lua_pushvalue(_luaState, -3); // obj key storage store key
-			lua_gettable(_luaState, -2); // obj key storage store store[k]
+		lua_settop(_luaState, 2); // obj key
+		lua_getmetatable(_luaState, 1); // obj key mt
+		if (getProperty(_luaState) == true) {
+			// obj value
+			return 1;
+		}
+		if (    lua_type(_luaState, 1) == LUA_TUSERDATA
+		     && lua_getuservalue(_luaState, 1) == LUA_TTABLE) {
+			// obj key mt store
+			lua_pushvalue(_luaState, 2); // obj key mt store key
+			if (lua_rawget(_luaState, -2) != LUA_TNIL) {
+				// obj key mt store store[k]
+				return 1;
+			}
 		}
 		// If either there is no storage table or the key wasn't found
 		// then fall back to the metatable
-		if (lua_isnil(_luaState, -1)) {
-			lua_settop(_luaState, 2); // obj key
-			lua_getmetatable(_luaState, -2); // obj key mt
-			lua_pushvalue(_luaState, -2); // obj key mt k
-			lua_gettable(_luaState, -2); // obj key mt mt[k]
-		}
+		lua_settop(_luaState, 3); // obj key mt
+		lua_pushvalue(_luaState, 2); // obj key mt k
+		lua_gettable(_luaState, -2); // obj key mt mt[k]
 		return 1;
 	}
 	
@@ -513,30 +1626,33 @@ namespace luaWrapper {
 	 * This function is called from Lua, not C++
 	 *
 	 * The default metamethod to call when creating a new index on lua userdata
-	 * representing an object of type T. This will index into the the userdata's
-	 * environment table that it keeps for personal storage. This is done so
-	 * individual userdata can be treated as a table, and can hold thier own
-	 * values.
+	 * representing an object of type T. This will call the setter of the
+	 * property or index into the the userdata's storage table (its user value,
+	 * created on the first field). This is done so individual userdata can be
+	 * treated as a table, and can hold thier own values. The storage table is
+	 * collected with the userdata.
 	 */
 	template <typename LUAW_TYPE>
 	int newindex(lua_State* _luaState) {
 		// obj key value
-		ememory::SharedPtr<LUAW_TYPE> obj = check<LUAW_TYPE>(_luaState, 1);
-		wrapperField<LUAW_TYPE>(_luaState, LUAW_STORAGE_KEY); // obj key value storage
-		LuaWrapper<LUAW_TYPE>::identifier(_luaState, obj); // obj key value storage id
-		lua_pushvalue(_luaState, -1); // obj key value storage id id
-		lua_gettable(_luaState, -3); // obj key value storage id store
+		checkRef<LUAW_TYPE>(_luaState, 1);
+		lua_settop(_luaState, 3); // obj key value
+		lua_getmetatable(_luaState, 1); // obj key value mt
+		if (setProperty(_luaState) == true) {
+			return 0;
+		}
+		lua_settop(_luaState, 3); // obj key value
 		// Add the storage table if there isn't one already
-		if (lua_isnil(_luaState, -1)) {
-			lua_pop(_luaState, 1); // obj key value storage id
-			lua_newtable(_luaState); // obj key value storage id store
-			lua_pushvalue(_luaState, -1); // obj key value storage id store store
-			lua_insert(_luaState, -3); // obj key value storage store id store
-			lua_settable(_luaState, -4); // obj key value storage store
-		}
-		lua_pushvalue(_luaState, 2); // obj key value ... store key
-		lua_pushvalue(_luaState, 3); // obj key value ... store key value
-		lua_settable(_luaState, -3); // obj key value ... store
+		if (lua_getuservalue(_luaState, 1) != LUA_TTABLE) {
+			// obj key value nil
+			lua_pop(_luaState, 1); // obj key value
+			lua_newtable(_luaState); // obj key value store
+			lua_pushvalue(_luaState, -1); // obj key value store store
+			lua_setuservalue(_luaState, 1); // obj key value store
+		}
+		lua_pushvalue(_luaState, 2); // obj key value store key
+		lua_pushvalue(_luaState, 3); // obj key value store key value
+		lua_rawset(_luaState, -3); // obj key value store
 		return 0;
 	}
 	
@@ -552,21 +1668,22 @@ namespace luaWrapper {
 		// obj
 		/*
 		ememory::SharedPtr<LUAW_TYPE> obj = to<LUAW_TYPE>(_luaState, 1);
-		LuaWrapper<LUAW_TYPE>::identifier(_luaState, obj); // obj key value storage id
+		pushIdentifier<LUAW_TYPE>(_luaState, obj); // obj key value storage id
 		wrapperField<LUAW_TYPE>(_luaState, LUAW_HOLDS_KEY); // obj id counts count holds
 		lua_pushvalue(_luaState, 2); // obj id counts count holds id
 		lua_gettable(_luaState, -2); // obj id counts count holds hold
 		if (lua_toboolean(_luaState, -1)) {
 			obj.reset();
 		}
-		wrapperField<LUAW_TYPE>(_luaState, LUAW_STORAGE_KEY); // obj id counts count holds hold storage
-		lua_pushvalue(_luaState, 2); // obj id counts count holds hold storage id
-		lua_pushnil(_luaState); // obj id counts count holds hold storage id nil
-		lua_settable(_luaState, -3); // obj id counts count holds hold storage
 		release<LUAW_TYPE>(_luaState, 2);
 		*/
-		Userdata *object = static_cast<Userdata*>( lua_touserdata( _luaState, 1 ) );
-		object->~Userdata();
+		// A script can call obj:__gc(): the userdata is only destroyed one time.
+		Userdata* object = getUserdata(_luaState, 1);
+		if (object != null) {
+			object->~Userdata();
+			// The magic is cleared: the memory is no more a LuaWrapper userdata.
+			memset(static_cast<void*>(object), 0, sizeof(Userdata));
+		}
 		lua_pop( _luaState, 1 );
 		return 0;
 	}
@@ -586,6 +1703,17 @@ namespace luaWrapper {
 		}
 	}
 	
+	/**
+	 * __gc of the binding context userdata: called when the state is closed.
+	 *
+	 * This function is only called from LuaWrapper internally. 
+	 */
+	inline int gcBindingContext(lua_State* _luaState) {
+		BindingContext* context = static_cast<BindingContext*>(lua_touserdata(_luaState, 1));
+		context->~BindingContext();
+		return 0;
+	}
+	
 	/**
 	 * Initializes the LuaWrapper tables used to track internal state. 
 	 *
@@ -598,9 +1726,6 @@ namespace luaWrapper {
 			lua_newtable(_luaState); // ... nil {}
 			lua_pushvalue(_luaState, -1); // ... nil {} {}
 			lua_setfield(_luaState, LUA_REGISTRYINDEX, LUAW_WRAPPER_KEY); // ... nil LuaWrapper
-			// Create a storage table
-			lua_newtable(_luaState); // ... LuaWrapper nil {}
-			lua_setfield(_luaState, -2, LUAW_STORAGE_KEY); // ... nil LuaWrapper
 			// Create a holds table
 			lua_newtable(_luaState); // ... LuaWrapper {}
 			lua_setfield(_luaState, -2, LUAW_HOLDS_KEY); // ... nil LuaWrapper
@@ -615,6 +1740,19 @@ namespace luaWrapper {
 			lua_pop(_luaState, 1); // ... nil
 		}
 		lua_pop(_luaState, 1); // ...
+		// Ensure that the binding context is set up
+		lua_rawgetp(_luaState, LUA_REGISTRYINDEX, bindingContextKey()); // ... ctx
+		if (lua_isnil(_luaState, -1)) {
+			lua_pop(_luaState, 1); // ...
+			new ((char*)lua_newuserdata(_luaState, sizeof(BindingContext))) BindingContext(); // ... ctx
+			lua_newtable(_luaState); // ... ctx {}
+			lua_pushcfunction(_luaState, gcBindingContext); // ... ctx {} gc
+			lua_setfield(_luaState, -2, "__gc"); // ... ctx {}
+			lua_setmetatable(_luaState, -2); // ... ctx
+			lua_rawsetp(_luaState, LUA_REGISTRYINDEX, bindingContextKey()); // ...
+		} else {
+			lua_pop(_luaState, 1); // ...
+		}
 	}
 	
 	/**
@@ -643,6 +1781,9 @@ namespace luaWrapper {
 	 * name. setfuncs is identical to register, but it does not set the
 	 * table globally.  As with luaL_register and luaL_setfuncs, both funcstions
 	 * leave the new table on the top of the stack.
+	 *
+	 * A type can be registered only one time in a state (an exception is thrown
+	 * the second time): the userdata already pushed keep their metatable.
 	 */
 	template <typename LUAW_TYPE>
 	void setfuncs(lua_State* _luaState,
@@ -652,9 +1793,13 @@ namespace luaWrapper {
 	                   ememory::SharedPtr<LUAW_TYPE> (*_allocator)(lua_State*),
 	                   void (*_identifier)(lua_State*, ememory::SharedPtr<LUAW_TYPE>)) {
 		initialize(_luaState);
-		LuaWrapper<LUAW_TYPE>::classname = _classname;
-		LuaWrapper<LUAW_TYPE>::identifier = _identifier;
-		LuaWrapper<LUAW_TYPE>::allocator = _allocator;
+		TypeBinding& binding = getBinding<LUAW_TYPE>(_luaState);
+		if (binding.m_metatable != LUA_NOREF) {
+			ETK_THROW_EXCEPTION(etk::exception::RuntimeError(etk::String("type already registered in this state as '") + binding.m_classname + "'"));
+		}
+		binding.m_classname = _classname;
+		binding.m_identifier = reinterpret_cast<void (*)()>(_identifier);
+		binding.m_allocator = reinterpret_cast<void (*)()>(_allocator);
 		const luaL_Reg defaulttable[] = {
 			{ "new", create<LUAW_TYPE> },
 			{ NULL, NULL }
@@ -665,27 +1810,29 @@ namespace luaWrapper {
 			{ "__gc", gc<LUAW_TYPE> }, 
 			{ NULL, NULL }
 		};
-		// Set up per-type tables
+		// Set up per-type tables (named in the LuaWrapper table and referenced in the binding context)
 		lua_getfield(_luaState, LUA_REGISTRYINDEX, LUAW_WRAPPER_KEY); // ... LuaWrapper
-		lua_getfield(_luaState, -1, LUAW_STORAGE_KEY); // ... LuaWrapper LuaWrapper.storage
-		lua_newtable(_luaState); // ... LuaWrapper LuaWrapper.storage {}
-		lua_setfield(_luaState, -2, LuaWrapper<LUAW_TYPE>::classname); // ... LuaWrapper LuaWrapper.storage
-		lua_pop(_luaState, 1); // ... LuaWrapper
 		lua_getfield(_luaState, -1, LUAW_HOLDS_KEY); // ... LuaWrapper LuaWrapper.holds
 		lua_newtable(_luaState); // ... LuaWrapper LuaWrapper.holds {}
-		lua_setfield(_luaState, -2, LuaWrapper<LUAW_TYPE>::classname); // ... LuaWrapper LuaWrapper.holds
+		lua_pushvalue(_luaState, -1); // ... LuaWrapper LuaWrapper.holds {} {}
+		binding.m_holds = luaL_ref(_luaState, LUA_REGISTRYINDEX); // ... LuaWrapper LuaWrapper.holds {}
+		lua_setfield(_luaState, -2, _classname); // ... LuaWrapper LuaWrapper.holds
 		lua_pop(_luaState, 1); // ... LuaWrapper
 		lua_getfield(_luaState, -1, LUAW_CACHE_KEY); // ... LuaWrapper LuaWrapper.cache
 		lua_newtable(_luaState); // ... LuaWrapper LuaWrapper.cache {}
-		wrapperField<LUAW_TYPE>(_luaState, LUAW_CACHE_METATABLE_KEY); // ... LuaWrapper LuaWrapper.cache {} cmt
+		lua_getfield(_luaState, -3, LUAW_CACHE_METATABLE_KEY); // ... LuaWrapper LuaWrapper.cache {} cmt
 		lua_setmetatable(_luaState, -2); // ... LuaWrapper LuaWrapper.cache {}
-		lua_setfield(_luaState, -2, LuaWrapper<LUAW_TYPE>::classname); // ... LuaWrapper LuaWrapper.cache
+		lua_pushvalue(_luaState, -1); // ... LuaWrapper LuaWrapper.cache {} {}
+		binding.m_cache = luaL_ref(_luaState, LUA_REGISTRYINDEX); // ... LuaWrapper LuaWrapper.cache {}
+		lua_setfield(_luaState, -2, _classname); // ... LuaWrapper LuaWrapper.cache
 		lua_pop(_luaState, 2); // ...
 		// Open table
 		lua_newtable(_luaState); // ... T
 		registerfuncs(_luaState, _allocator ? defaulttable : NULL, _table); // ... T
 		// Open metatable, set up extends table
 		luaL_newmetatable(_luaState, _classname); // ... T mt
+		lua_pushvalue(_luaState, -1); // ... T mt mt
+		binding.m_metatable = luaL_ref(_luaState, LUA_REGISTRYINDEX); // ... T mt
 		lua_newtable(_luaState); // ... T mt {}
 		lua_setfield(_luaState, -2, LUAW_EXTENDS_KEY); // ... T mt
 		registerfuncs(_luaState, defaultmetatable, _metatable); // ... T mt
@@ -740,6 +1887,20 @@ namespace luaWrapper {
 		lua_setglobal(_lua.getState(), _classname); // ... T
 	}
 	
+	/**
+	 * Add a type ID in an ancestors list (if not already present).
+	 *
+	 * This function is only called from LuaWrapper internally.
+	 */
+	inline void extendAncestors(etk::Vector<size_t>& _ancestors, size_t _typeId) {
+		for (auto &it: _ancestors) {
+			if (it == _typeId) {
+				return;
+			}
+		}
+		_ancestors.pushBack(_typeId);
+	}
+	
 	/**
 	 * extend is used to declare that class T inherits from class U. All
 	 * functions in the base class will be available to the derived class (except
@@ -749,17 +1910,23 @@ namespace luaWrapper {
 	 */
 	template <typename LUAW_TYPE, typename LUAW_TYPE2>
 	void extend(lua_State* _luaState) {
-		if(!LuaWrapper<LUAW_TYPE>::classname) {
+		TypeBinding& binding = getBinding<LUAW_TYPE>(_luaState);
+		TypeBinding& bindingParent = getBinding<LUAW_TYPE2>(_luaState);
+		if(!binding.m_classname) {
 			luaL_error(_luaState, "attempting to call extend on a type that has not been registered");
 		}
-		if(!LuaWrapper<LUAW_TYPE2>::classname) {
-			luaL_error(_luaState, "attempting to extend %s by a type that has not been registered", LuaWrapper<LUAW_TYPE>::classname);
+		if(!bindingParent.m_classname) {
+			luaL_error(_luaState, "attempting to extend %s by a type that has not been registered", binding.m_classname);
+		}
+		binding.m_identifier = reinterpret_cast<void (*)()>(identify<LUAW_TYPE, LUAW_TYPE2>);
+		binding.m_postconstructorrecurse = postconstructorinternal<LUAW_TYPE2>;
+		// Make a list of all types T inherit from, for the fast type checking
+		extendAncestors(binding.m_ancestors, ETK_GET_TYPE_ID(LUAW_TYPE2));
+		for (auto &it: bindingParent.m_ancestors) {
+			extendAncestors(binding.m_ancestors, it);
 		}
-		//LuaWrapper<LUAW_TYPE>::cast = cast<LUAW_TYPE, LUAW_TYPE2>;
-		LuaWrapper<LUAW_TYPE>::identifier = identify<LUAW_TYPE, LUAW_TYPE2>;
-		LuaWrapper<LUAW_TYPE>::postconstructorrecurse = postconstructorinternal<LUAW_TYPE2>;
-		luaL_getmetatable(_luaState, LuaWrapper<LUAW_TYPE>::classname); // mt
-		luaL_getmetatable(_luaState, LuaWrapper<LUAW_TYPE2>::classname); // mt emt
+		lua_rawgeti(_luaState, LUA_REGISTRYINDEX, binding.m_metatable); // mt
+		lua_rawgeti(_luaState, LUA_REGISTRYINDEX, bindingParent.m_metatable); // mt emt
 		// Point T's metatable __index at U's metatable for inheritance
 		lua_newtable(_luaState); // mt emt {}
 		lua_pushvalue(_luaState, -2); // mt emt {} emt
@@ -767,22 +1934,21 @@ namespace luaWrapper {
 		lua_setmetatable(_luaState, -3); // mt emt
 		// Set up per-type tables to point at parent type
 		lua_getfield(_luaState, LUA_REGISTRYINDEX, LUAW_WRAPPER_KEY); // ... LuaWrapper
-		lua_getfield(_luaState, -1, LUAW_STORAGE_KEY); // ... LuaWrapper LuaWrapper.storage
-		lua_getfield(_luaState, -1, LuaWrapper<LUAW_TYPE2>::classname); // ... LuaWrapper LuaWrapper.storage U
-		lua_setfield(_luaState, -2, LuaWrapper<LUAW_TYPE>::classname); // ... LuaWrapper LuaWrapper.storage
-		lua_pop(_luaState, 1); // ... LuaWrapper
 		lua_getfield(_luaState, -1, LUAW_HOLDS_KEY); // ... LuaWrapper LuaWrapper.holds
-		lua_getfield(_luaState, -1, LuaWrapper<LUAW_TYPE2>::classname); // ... LuaWrapper LuaWrapper.holds U
-		lua_setfield(_luaState, -2, LuaWrapper<LUAW_TYPE>::classname); // ... LuaWrapper LuaWrapper.holds
+		lua_getfield(_luaState, -1, bindingParent.m_classname); // ... LuaWrapper LuaWrapper.holds U
+		lua_setfield(_luaState, -2, binding.m_classname); // ... LuaWrapper LuaWrapper.holds
 		lua_pop(_luaState, 1); // ... LuaWrapper
 		lua_getfield(_luaState, -1, LUAW_CACHE_KEY); // ... LuaWrapper LuaWrapper.cache
-		lua_getfield(_luaState, -1, LuaWrapper<LUAW_TYPE2>::classname); // ... LuaWrapper LuaWrapper.cache U
-		lua_setfield(_luaState, -2, LuaWrapper<LUAW_TYPE>::classname); // ... LuaWrapper LuaWrapper.cache
+		lua_getfield(_luaState, -1, bindingParent.m_classname); // ... LuaWrapper LuaWrapper.cache U
+		lua_setfield(_luaState, -2, binding.m_classname); // ... LuaWrapper LuaWrapper.cache
 		lua_pop(_luaState, 2); // ...
+		// Same for the references of the binding context
+		binding.m_holds = bindingParent.m_holds;
+		binding.m_cache = bindingParent.m_cache;
 		// Make a list of all types that inherit from U, for type checking
 		lua_getfield(_luaState, -2, LUAW_EXTENDS_KEY); // mt emt mt.extends
 		lua_pushvalue(_luaState, -2); // mt emt mt.extends emt
-		lua_setfield(_luaState, -2, LuaWrapper<LUAW_TYPE2>::classname); // mt emt mt.extends
+		lua_setfield(_luaState, -2, bindingParent.m_classname); // mt emt mt.extends
 		lua_getfield(_luaState, -2, LUAW_EXTENDS_KEY); // mt emt mt.extends emt.extends
 		for (lua_pushnil(_luaState); lua_next(_luaState, -2); lua_pop(_luaState, 1)) {
 			// mt emt mt.extends emt.extends k v
@@ -792,6 +1958,431 @@ namespace luaWrapper {
 		}
 		lua_pop(_luaState, 4); // mt emt
 	}
+	
+	/**
+	 * This function is called from Lua, not C++
+	 *
+	 * __newindex of the sealed types: no field can be added to the objects.
+	 */
+	template <typename LUAW_TYPE>
+	int sealedNewindex(lua_State* _luaState) {
+		// obj key value
+		checkRef<LUAW_TYPE>(_luaState, 1);
+		lua_settop(_luaState, 3); // obj key value
+		lua_getmetatable(_luaState, 1); // obj key value mt
+		if (setProperty(_luaState) == true) {
+			return 0;
+		}
+		const char* classname = getClassname<LUAW_TYPE>(_luaState);
+		return luaL_error(_luaState, "can not add the field '%s' to a sealed %s object", luaL_tolstring(_luaState, 2, NULL), classname != null ? classname : "userdata");
+	}
+	
+	/**
+	 * seal is used to declare that the objects of type T never get fields set
+	 * from lua (no per-object storage). The __index of T's metatable becomes the
+	 * metatable itself: the methods are found by the lua VM without calling
+	 * index<T> (and the storage table lookup), and __newindex raises an error.
+	 *
+	 * Call it after setfuncs/registerElement (and extend if needed). A custom
+	 * __index or __newindex given in the metatable is replaced. A type with
+	 * properties (see setProperties) keeps index<T> to call the getters.
+	 */
+	template <typename LUAW_TYPE>
+	void seal(lua_State* _luaState) {
+		TypeBinding& binding = getBinding<LUAW_TYPE>(_luaState);
+		if(!binding.m_classname) {
+			luaL_error(_luaState, "attempting to call seal on a type that has not been registered");
+		}
+		binding.m_sealed = true;
+		lua_rawgeti(_luaState, LUA_REGISTRYINDEX, binding.m_metatable); // mt
+		if (lua_getfield(_luaState, -1, LUAW_GETTERS_KEY) != LUA_TTABLE) {
+			// mt nil
+			lua_pushvalue(_luaState, -2); // mt nil mt
+			lua_setfield(_luaState, -3, "__index"); // mt nil
+		}
+		lua_pop(_luaState, 1); // mt
+		lua_pushcfunction(_luaState, sealedNewindex<LUAW_TYPE>); // mt newindex
+		lua_setfield(_luaState, -2, "__newindex"); // mt
+		lua_pop(_luaState, 1); // ...
+	}
+	
+	/**
+	 * Get (or create) a property table of the metatable on the top of the stack.
+	 * A new table starts with a copy of the properties inherited from the
+	 * parent type (see extend).
+	 *
+	 * This function is only called from LuaWrapper internally.
+	 */
+	inline void propertyTable(lua_State* _luaState, const char* _key) {
+		// mt
+		lua_pushstring(_luaState, _key); // mt key
+		if (lua_rawget(_luaState, -2) == LUA_TTABLE) {
+			// mt properties
+			return;
+		}
+		lua_pop(_luaState, 1); // mt
+		lua_newtable(_luaState); // mt {}
+		if (lua_getfield(_luaState, -2, _key) == LUA_TTABLE) {
+			// mt {} parent
+			for (lua_pushnil(_luaState); lua_next(_luaState, -2); lua_pop(_luaState, 1)) {
+				// mt {} parent k v
+				lua_pushvalue(_luaState, -2); // mt {} parent k v k
+				lua_pushvalue(_luaState, -2); // mt {} parent k v k v
+				lua_rawset(_luaState, -6); // mt {} parent k v
+			}
+		}
+		lua_pop(_luaState, 1); // mt {}
+		lua_pushvalue(_luaState, -1); // mt {} {}
+		lua_setfield(_luaState, -3, _key); // mt {}
+	}
+	
+	/**
+	 * setProperties add field-style access to the objects of type T:
+	 *
+	 *   static luaWrapper::Property Foo_properties[] = {
+	 *   	{ "x", luaWrapper::utils::get<Foo, int, &Foo::m_x>, luaWrapper::utils::set<Foo, int, &Foo::m_x> },
+	 *   	{ "name", luaWrapper::utils::get<Foo, etk::String, &Foo::getName>, NULL },
+	 *   	{ NULL, NULL, NULL }
+	 *   };
+	 *   luaWrapper::setProperties<Foo>(L, Foo_properties);
+	 *
+	 * Lua: foo.x = foo.x + 1 (foo.name = "" raises an error: read-only).
+	 *
+	 * index<T>/newindex<T> find the getter/setter with one raw lookup of the
+	 * key (an interned lua string: its hash is already computed) in a table of
+	 * the metatable, and call it directly (no method lookup and no lua_call).
+	 * The properties have the priority on the per-object fields and on the
+	 * methods, and are inherited by the types that extend T (set the
+	 * properties of the parent before the ones of the child).
+	 */
+	template <typename LUAW_TYPE>
+	void setProperties(lua_State* _luaState, const Property* _properties) {
+		TypeBinding& binding = getBinding<LUAW_TYPE>(_luaState);
+		if(!binding.m_classname) {
+			luaL_error(_luaState, "attempting to set the properties of a type that has not been registered");
+		}
+		lua_rawgeti(_luaState, LUA_REGISTRYINDEX, binding.m_metatable); // mt
+		propertyTable(_luaState, LUAW_GETTERS_KEY); // mt getters
+		lua_insert(_luaState, -2); // getters mt
+		propertyTable(_luaState, LUAW_SETTERS_KEY); // getters mt setters
+		for (const Property* it = _properties; it->name != null; ++it) {
+			if (it->getter != null) {
+				lua_pushcfunction(_luaState, it->getter); // getters mt setters getter
+				lua_setfield(_luaState, -4, it->name); // getters mt setters
+			}
+			if (it->setter != null) {
+				lua_pushcfunction(_luaState, it->setter); // getters mt setters setter
+			} else {
+				// read-only property
+				lua_pushboolean(_luaState, false); // getters mt setters false
+			}
+			lua_setfield(_luaState, -2, it->name); // getters mt setters
+		}
+		lua_pop(_luaState, 1); // getters mt
+		if (binding.m_sealed == true) {
+			// The getters need index<T> (see seal)
+			lua_pushcfunction(_luaState, index<LUAW_TYPE>); // getters mt index
+			lua_setfield(_luaState, -2, "__index"); // getters mt
+		}
+		lua_pop(_luaState, 2); // ...
+	}
+	
+	/**
+	 * Push the getter (_key = LUAW_GETTERS_KEY) or the setter (LUAW_SETTERS_KEY)
+	 * of a property of T (raise an error if there is none).
+	 *
+	 * This function is only called from LuaWrapper internally.
+	 */
+	template <typename LUAW_TYPE>
+	void pushPropertyFunction(lua_State* _luaState, const char* _key, const char* _name) {
+		TypeBinding& binding = getBinding<LUAW_TYPE>(_luaState);
+		if(!binding.m_classname) {
+			luaL_error(_luaState, "attempting to use the properties of a type that has not been registered");
+		}
+		lua_rawgeti(_luaState, LUA_REGISTRYINDEX, binding.m_metatable); // ... mt
+		int type = LUA_TNIL;
+		if (lua_getfield(_luaState, -1, _key) == LUA_TTABLE) {
+			// ... mt properties
+			type = lua_getfield(_luaState, -1, _name); // ... mt properties func
+			lua_remove(_luaState, -2); // ... mt func
+		}
+		lua_remove(_luaState, -2); // ... func
+		if (type == LUA_TBOOLEAN) {
+			luaL_error(_luaState, "property '%s' is read-only", _name);
+		}
+		if (type != LUA_TFUNCTION) {
+			luaL_error(_luaState, "no property '%s' in %s", _name, binding.m_classname);
+		}
+	}
+	
+	/**
+	 * This function is called from Lua, not C++
+	 *
+	 * gather and scatter read or write one property (see setProperties) of all
+	 * the objects of a list in one call, instead of one __index (or method
+	 * call) per object from the script. Add them to the table of the type:
+	 *
+	 *   static luaL_Reg Foo_table[] = {
+	 *   	{ "gather", luaWrapper::gather<Foo> },
+	 *   	{ "scatter", luaWrapper::scatter<Foo> },
+	 *   	{ NULL, NULL }
+	 *   };
+	 *
+	 * Lua:
+	 *   local xs = Foo.gather(list, "x") -- new table {list[1].x, list[2].x...}
+	 *   Foo.gather(list, "x", Float32Array.new(#list)) -- fill (and return) an existing table or array
+	 *   Foo.scatter(list, "x", xs) -- list[i].x = xs[i] (xs: table, typed array or view)
+	 *   Foo.scatter(list, "x", 0) -- list[i].x = 0 (any other value)
+	 *
+	 * The property is found once, and its getter/setter is called directly for
+	 * each object (it checks the type of the object).
+	 */
+	template <typename LUAW_TYPE>
+	int gather(lua_State* _luaState) {
+		// list name [out]
+		luaL_checktype(_luaState, 1, LUA_TTABLE);
+		const char* name = luaL_checkstring(_luaState, 2);
+		lua_Integer size = lua_Integer(lua_rawlen(_luaState, 1));
+		lua_settop(_luaState, 3); // list name out
+		if (lua_isnil(_luaState, 3)) {
+			lua_pop(_luaState, 1); // list name
+			lua_createtable(_luaState, int(size), 0); // list name out
+		}
+		bool raw = lua_type(_luaState, 3) == LUA_TTABLE;
+		pushPropertyFunction<LUAW_TYPE>(_luaState, LUAW_GETTERS_KEY, name); // list name out getter
+		for (lua_Integer iii=1; iii<=size; ++iii) {
+			lua_pushvalue(_luaState, 4); // list name out getter getter
+			lua_rawgeti(_luaState, 1, iii); // list name out getter getter obj
+			lua_call(_luaState, 1, 1); // list name out getter value
+			if (raw == true) {
+				lua_rawseti(_luaState, 3, iii); // list name out getter
+			} else {
+				// typed array, view...
+				lua_seti(_luaState, 3, iii); // list name out getter
+			}
+		}
+		lua_settop(_luaState, 3); // list name out
+		return 1;
+	}
+	
+	/**
+	 * This function is called from Lua, not C++ (see gather)
+	 */
+	template <typename LUAW_TYPE>
+	int scatter(lua_State* _luaState) {
+		// list name values
+		luaL_checktype(_luaState, 1, LUA_TTABLE);
+		const char* name = luaL_checkstring(_luaState, 2);
+		luaL_checkany(_luaState, 3);
+		lua_Integer size = lua_Integer(lua_rawlen(_luaState, 1));
+		lua_settop(_luaState, 3); // list name values
+		int type = lua_type(_luaState, 3);
+		// A userdata with a length is a list of values (typed array, view...), an other one a single value.
+		bool indexed = type == LUA_TTABLE;
+		if (    type == LUA_TUSERDATA
+		     && luaL_getmetafield(_luaState, 3, "__len") != LUA_TNIL) {
+			// list name values len
+			lua_pop(_luaState, 1); // list name values
+			indexed = true;
+		}
+		pushPropertyFunction<LUAW_TYPE>(_luaState, LUAW_SETTERS_KEY, name); // list name values setter
+		for (lua_Integer iii=1; iii<=size; ++iii) {
+			lua_pushvalue(_luaState, 4); // list name values setter setter
+			lua_rawgeti(_luaState, 1, iii); // list name values setter setter obj
+			if (type == LUA_TTABLE) {
+				lua_rawgeti(_luaState, 3, iii); // list name values setter setter obj value
+			} else if (indexed == true) {
+				// typed array, view...
+				lua_geti(_luaState, 3, iii); // list name values setter setter obj value
+			} else {
+				// same value for all the objects
+				lua_pushvalue(_luaState, 3); // list name values setter setter obj value
+			}
+			lua_call(_luaState, 2, 0); // list name values setter
+		}
+		return 0;
+	}
+	
+	/**
+	 * Value types: small structures (vectors, colors...) stored directly in the
+	 * userdata block, without SharedPtr, cache or holds entry. The object is
+	 * copied when it is pushed, and destroyed by __gc (no __gc for the trivially
+	 * destructible types).
+	 *
+	 *   luaWrapper::registerValue<Vector2D>(lua, "Vector2D", NULL, Vector2D_metatable);
+	 *   luaWrapper::pushValue<Vector2D>(L, Vector2D(1, 2));
+	 *   Vector2D& vec = luaWrapper::checkValue<Vector2D>(L, 1);
+	 *
+	 * A type can be converted as a value type everywhere with the utils specializations:
+	 *   template<> void luaWrapper::utils::push<Vector2D>(lua_State* _L, const Vector2D& _value) {
+	 *   	luaWrapper::pushValue<Vector2D>(_L, _value);
+	 *   }
+	 *
+	 * The methods are found in the metatable by the lua VM (__index is the
+	 * metatable itself), a value type has no per-object storage.
+	 */
+	/**
+	 * Alignment of the memory of lua_newuserdata (LUAI_MAXALIGN of luaconf.h).
+	 */
+	union UserdataAlign {
+		lua_Number m_number;
+		double m_double;
+		void* m_pointer;
+		lua_Integer m_integer;
+		long m_long;
+	};
+	
+	template <typename LUAW_TYPE>
+	struct ValueUserdata {
+		// The value is not realigned in the userdata (for a bigger alignment, use registerElement).
+		static_assert(alignof(LUAW_TYPE) <= alignof(UserdataAlign), "the alignment of a value type must not be bigger than the one of a lua userdata");
+		uint64_t m_magic; //!< userdataMagic(this, LUAW_VALUE_MAGIC) (an Userdata has its magic at the same place, 0 when destroyed)
+		size_t m_typeId; //!< ETK_GET_TYPE_ID of LUAW_TYPE
+		LUAW_TYPE m_value;
+		template<class ... LUAW_ARGS>
+		ValueUserdata(LUAW_ARGS&&... _args) :
+		  m_magic(userdataMagic(this, LUAW_VALUE_MAGIC)),
+		  m_typeId(ETK_GET_TYPE_ID(LUAW_TYPE)),
+		  m_value(etk::forward<LUAW_ARGS>(_args)...) {
+			
+		}
+	};
+	
+	/**
+	 * Get the value at the given index (NULL if it is not a value of type T).
+	 * The pointer is valid as long as the userdata is referenced.
+	 */
+	template <typename LUAW_TYPE>
+	LUAW_TYPE* toValue(lua_State* _luaState, int _index) {
+		if (    lua_type(_luaState, _index) != LUA_TUSERDATA
+		     || lua_rawlen(_luaState, _index) < sizeof(ValueUserdata<LUAW_TYPE>)) {
+			return null;
+		}
+		ValueUserdata<LUAW_TYPE>* pud = static_cast<ValueUserdata<LUAW_TYPE>*>(lua_touserdata(_luaState, _index));
+		if (    pud->m_magic != userdataMagic(pud, LUAW_VALUE_MAGIC)
+		     || pud->m_typeId != ETK_GET_TYPE_ID(LUAW_TYPE)) {
+			return null;
+		}
+		return &pud->m_value;
+	}
+	
+	template <typename LUAW_TYPE>
+	bool isValue(lua_State* _luaState, int _index) {
+		return toValue<LUAW_TYPE>(_luaState, _index) != null;
+	}
+	
+	/**
+	 * Get the value at the given index, raise an error if it is not a value of type T.
+	 */
+	template <typename LUAW_TYPE>
+	LUAW_TYPE& checkValue(lua_State* _luaState, int _index) {
+		LUAW_TYPE* value = toValue<LUAW_TYPE>(_luaState, _index);
+		if (value == null) {
+			const char* classname = getClassname<LUAW_TYPE>(_luaState);
+			const char *msg = lua_pushfstring(_luaState, "%s expected, got %s", classname != null ? classname : "value", luaL_typename(_luaState, _index));
+			luaL_argerror(_luaState, _index, msg);
+		}
+		return *value;
+	}
+	
+	/**
+	 * Construct a value directly in a new userdata and push it.
+	 * @return The value in the userdata.
+	 */
+	template <typename LUAW_TYPE, class ... LUAW_ARGS>
+	LUAW_TYPE& emplaceValue(lua_State* _luaState, LUAW_ARGS&&... _args) {
+		TypeBinding& binding = getBinding<LUAW_TYPE>(_luaState);
+		if (binding.m_metatable == LUA_NOREF) {
+			luaL_error(_luaState, "attempting to push a value type that has not been registered in this state");
+		}
+		ValueUserdata<LUAW_TYPE>* ud = new ((char*)lua_newuserdata(_luaState, sizeof(ValueUserdata<LUAW_TYPE>))) ValueUserdata<LUAW_TYPE>(etk::forward<LUAW_ARGS>(_args)...); // ... ud
+		lua_rawgeti(_luaState, LUA_REGISTRYINDEX, binding.m_metatable); // ... ud mt
+		lua_setmetatable(_luaState, -2); // ... ud
+		return ud->m_value;
+	}
+	
+	/**
+	 * Push a copy of a value.
+	 */
+	template <typename LUAW_TYPE>
+	void pushValue(lua_State* _luaState, const LUAW_TYPE& _value) {
+		emplaceValue<LUAW_TYPE>(_luaState, _value);
+	}
+	
+	/**
+	 * This function is called from Lua, not C++
+	 *
+	 * Default "new" of a value type: push a default constructed value.
+	 */
+	template <typename LUAW_TYPE>
+	int createValue(lua_State* _luaState) {
+		emplaceValue<LUAW_TYPE>(_luaState);
+		return 1;
+	}
+	
+	/**
+	 * This function is called from Lua, not C++
+	 *
+	 * __gc of the value types that need a destructor.
+	 */
+	template <typename LUAW_TYPE>
+	int gcValue(lua_State* _luaState) {
+		if (toValue<LUAW_TYPE>(_luaState, 1) != null) {
+			ValueUserdata<LUAW_TYPE>* pud = static_cast<ValueUserdata<LUAW_TYPE>*>(lua_touserdata(_luaState, 1));
+			pud->m_value.~LUAW_TYPE();
+			// The metatable is its own __index: a script can call v:__gc(). The
+			// destroyed value is no more a value (no second destruction, no access).
+			pud->m_magic = 0;
+		}
+		return 0;
+	}
+	
+	/**
+	 * Same as setfuncs for a value type (the table contain "new" if the type is
+	 * default constructible). Leave the new table on the top of the stack. A
+	 * type can be registered only one time in a state.
+	 */
+	template <typename LUAW_TYPE>
+	void setfuncsValue(lua_State* _luaState,
+	                   const char* _classname,
+	                   const luaL_Reg* _table,
+	                   const luaL_Reg* _metatable) {
+		initialize(_luaState);
+		TypeBinding& binding = getBinding<LUAW_TYPE>(_luaState);
+		if (binding.m_metatable != LUA_NOREF) {
+			ETK_THROW_EXCEPTION(etk::exception::RuntimeError(etk::String("type already registered in this state as '") + binding.m_classname + "'"));
+		}
+		binding.m_classname = _classname;
+		const luaL_Reg defaulttable[] = {
+			{ "new", createValue<LUAW_TYPE> },
+			{ NULL, NULL }
+		};
+		// Open table
+		lua_newtable(_luaState); // ... T
+		registerfuncs(_luaState, std::is_default_constructible<LUAW_TYPE>::value ? defaulttable : NULL, _table); // ... T
+		// Open metatable: the methods are found by the VM without a C call
+		luaL_newmetatable(_luaState, _classname); // ... T mt
+		lua_pushvalue(_luaState, -1); // ... T mt mt
+		binding.m_metatable = luaL_ref(_luaState, LUA_REGISTRYINDEX); // ... T mt
+		lua_pushvalue(_luaState, -1); // ... T mt mt
+		lua_setfield(_luaState, -2, "__index"); // ... T mt
+		if (std::is_trivially_destructible<LUAW_TYPE>::value == false) {
+			lua_pushcfunction(_luaState, gcValue<LUAW_TYPE>); // ... T mt gc
+			lua_setfield(_luaState, -2, "__gc"); // ... T mt
+		}
+		registerfuncs(_luaState, NULL, _metatable); // ... T mt
+		lua_setfield(_luaState, -2, "metatable"); // ... T
+	}
+	
+	template <typename LUAW_TYPE>
+	void registerValue(Lua& _lua,
+	                   const char* _classname,
+	                   const luaL_Reg* _table,
+	                   const luaL_Reg* _metatable) {
+		setfuncsValue<LUAW_TYPE>(_lua.getState(), _classname, _table, _metatable); // ... T
+		lua_pushvalue(_lua.getState(), -1); // ... T T
+		lua_setglobal(_lua.getState(), _classname); // ... T
+	}
 
 }
 
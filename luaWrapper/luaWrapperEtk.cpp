@@ -22,110 +22,135 @@ namespace luaWrapper {
 		 * be able to convert it to and from Lua's primitive types, like strings or
 		 * tables.
 		 *
-		 * To do this, you must write luaWrapper::utils::check, luaWrapper::utils::to and luaWrapper::utils::push functions for
+		 * To do this, you must write luaWrapper::utils::Converter<T>::check, to and push functions for
 		 * your type. You don't always need all three, it depends on if you're pushing
 		 * objects to Lua, getting objects from Lua, or both.
 		 *
 		 * This example uses etk::String, but if you have other custom string types it
 		 * should be easy to write versions of those functions too
 		 */
-		template<> etk::String check<etk::String>(lua_State* _luaState, int _index) {
-		    return etk::String(luaL_checkstring(_luaState, _index));
+		template<> etk::String Converter<etk::String>::check(lua_State* _luaState, int _index) {
+			size_t size = 0;
+			const char* data = luaL_checklstring(_luaState, _index, &size);
+			return etk::String(data, size);
+		}
+		template<> etk::String Converter<etk::String>::to(lua_State* _luaState, int _index) {
+			size_t size = 0;
+			const char* data = lua_tolstring(_luaState, _index, &size);
+			if (data == null) {
+				return etk::String();
+			}
+			return etk::String(data, size);
+		}
+		template<> void Converter<etk::String>::push(lua_State* _luaState, const etk::String& _val) {
+			// The length is known: no strlen, and the embedded '\0' are kept.
+			lua_pushlstring(_luaState, _val.c_str(), _val.size());
 		}
-		template<> etk::String to<etk::String>(lua_State* _luaState, int _index) {
-		    return etk::String(lua_tostring(_luaState, _index));
-		}
-		template<> void push<etk::String>(lua_State* _luaState, const etk::String& _val) {
-		    lua_pushstring(_luaState, _val.c_str());
+		
+		template<> StringView Converter<StringView>::check(lua_State* _luaState, int _index) {
+			size_t size = 0;
+			const char* data = luaL_checklstring(_luaState, _index, &size);
+			return StringView(data, size);
+		}
+		template<> StringView Converter<StringView>::to(lua_State* _luaState, int _index) {
+			size_t size = 0;
+			const char* data = lua_tolstring(_luaState, _index, &size);
+			if (data == null) {
+				return StringView();
+			}
+			return StringView(data, size);
+		}
+		template<> void Converter<StringView>::push(lua_State* _luaState, const StringView& _value) {
+			lua_pushlstring(_luaState, _value.data(), _value.size());
 		}
 		
-		template<> bool check<bool>(lua_State* _luaState, int _index) {
+		template<> bool Converter<bool>::check(lua_State* _luaState, int _index) {
 			return lua_toboolean(_luaState, _index) != 0;
 		}
-		template<> bool to<bool>(lua_State* _luaState, int _index) {
+		template<> bool Converter<bool>::to(lua_State* _luaState, int _index) {
 			return lua_toboolean(_luaState, _index) != 0;
 		}
-		template<> void push<bool>(lua_State* _luaState, const bool& _value) {
+		template<> void Converter<bool>::push(lua_State* _luaState, const bool& _value) {
 			lua_pushboolean(_luaState, _value);
 		}
 		
-		template<> const char* check<const char*>(lua_State* _luaState, int _index) {
+		template<> const char* Converter<const char*>::check(lua_State* _luaState, int _index) {
 			return luaL_checkstring(_luaState, _index);
 		}
-		template<> const char* to<const char*>(lua_State* _luaState, int _index) {
+		template<> const char* Converter<const char*>::to(lua_State* _luaState, int _index) {
 			return lua_tostring(_luaState, _index);
 		}
-		template<> void push<const char*>(lua_State* _luaState, const char* const& _value) {
+		template<> void Converter<const char*>::push(lua_State* _luaState, const char* const& _value) {
 			lua_pushstring(_luaState, _value);
 		}
 		
-		template<> const char* const check<const char* const>(lua_State* _luaState, int _index) {
+		template<> const char* const Converter<const char* const>::check(lua_State* _luaState, int _index) {
 			return luaL_checkstring(_luaState, _index);
 		}
-		template<> const char* const to<const char* const>(lua_State* _luaState, int _index) {
+		template<> const char* const Converter<const char* const>::to(lua_State* _luaState, int _index) {
 			return lua_tostring(_luaState, _index);
 		}
-		template<> void push<const char* const>(lua_State* _luaState, const char* const& _value) {
+		template<> void Converter<const char* const>::push(lua_State* _luaState, const char* const& _value) {
 			lua_pushstring(_luaState, _value);
 		}
 		
-		template<> unsigned int check<unsigned int>(lua_State* _luaState, int _index) {
+		template<> unsigned int Converter<unsigned int>::check(lua_State* _luaState, int _index) {
 			return static_cast<unsigned int>(luaL_checkinteger(_luaState, _index));
 		}
-		template<> unsigned int to<unsigned int>(lua_State* _luaState, int _index) {
+		template<> unsigned int Converter<unsigned int>::to(lua_State* _luaState, int _index) {
 			return static_cast<unsigned int>(lua_tointeger(_luaState, _index));
 		}
-		template<> void push<unsigned int>(lua_State* _luaState, const unsigned int& _value) {
+		template<> void Converter<unsigned int>::push(lua_State* _luaState, const unsigned int& _value) {
 			lua_pushinteger(_luaState, _value);
 		}
 		
-		template<> int check<int>(lua_State* _luaState, int _index) {
+		template<> int Converter<int>::check(lua_State* _luaState, int _index) {
 			return static_cast<int>(luaL_checkinteger(_luaState, _index));
 		}
-		template<> int to<int>(lua_State* _luaState, int _index) {
+		template<> int Converter<int>::to(lua_State* _luaState, int _index) {
 			return static_cast<int>(lua_tointeger(_luaState, _index));
 		}
-		template<> void push<int>(lua_State* _luaState, const int& _value) {
+		template<> void Converter<int>::push(lua_State* _luaState, const int& _value) {
 			lua_pushinteger(_luaState, _value);
 		}
 		
-		template<> unsigned char check<unsigned char>(lua_State* _luaState, int _index) {
+		template<> unsigned char Converter<unsigned char>::check(lua_State* _luaState, int _index) {
 			return static_cast<unsigned char>(luaL_checkinteger(_luaState, _index));
 		}
-		template<> unsigned char to<unsigned char>(lua_State* _luaState, int _index) {
+		template<> unsigned char Converter<unsigned char>::to(lua_State* _luaState, int _index) {
 			return static_cast<unsigned char>(lua_tointeger(_luaState, _index));
 		}
-		template<> void push<unsigned char>(lua_State* _luaState, const unsigned char& _value) {
+		template<> void Converter<unsigned char>::push(lua_State* _luaState, const unsigned char& _value) {
 			lua_pushinteger(_luaState, _value);
 		}
 		
-		template<> char check<char>(lua_State* _luaState, int _index) {
+		template<> char Converter<char>::check(lua_State* _luaState, int _index) {
 			return static_cast<char>(luaL_checkinteger(_luaState, _index));
 		}
-		template<> char to<char>(lua_State* _luaState, int _index) {
+		template<> char Converter<char>::to(lua_State* _luaState, int _index) {
 			return static_cast<char>(lua_tointeger(_luaState, _index));
 		}
-		template<> void push<char>(lua_State* _luaState, const char& _value) {
+		template<> void Converter<char>::push(lua_State* _luaState, const char& _value) {
 			lua_pushinteger(_luaState, _value);
 		}
 		
-		template<> float check<float>(lua_State* _luaState, int _index) {
+		template<> float Converter<float>::check(lua_State* _luaState, int _index) {
 			return static_cast<float>(luaL_checknumber(_luaState, _index));
 		}
-		template<> float to<float>(lua_State* _luaState, int _index) {
+		template<> float Converter<float>::to(lua_State* _luaState, int _index) {
 			return static_cast<float>(lua_tonumber(_luaState, _index));
 		}
-		template<> void push<float>(lua_State* _luaState, const float& _value) {
+		template<> void Converter<float>::push(lua_State* _luaState, const float& _value) {
 			lua_pushnumber(_luaState, _value);
 		}
 		
-		template<> double check<double>(lua_State* _luaState, int _index) {
+		template<> double Converter<double>::check(lua_State* _luaState, int _index) {
 			return static_cast<double>(luaL_checknumber(_luaState, _index));
 		}
-		template<> double to<double>(lua_State* _luaState, int _index) {
+		template<> double Converter<double>::to(lua_State* _luaState, int _index) {
 			return static_cast<double>(lua_tonumber(_luaState, _index));
 		}
-		template<> void push<double>(lua_State* _luaState, const double& _value) {
+		template<> void Converter<double>::push(lua_State* _luaState, const double& _value) {
 			lua_pushnumber(_luaState, _value);
 		}
 	}
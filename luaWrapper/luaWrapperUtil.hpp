@@ -130,210 +130,208 @@ namespace luaWrapper {
 		 */
 		
 		template <typename LUAW_TYPE, typename U, U LUAW_TYPE::*Member> int get(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			luaWrapper::utils::push<U>(_luaState, obj.get()->*Member);
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			luaWrapper::utils::push<U>(_luaState, obj.*Member);
 			return 1;
 		}
 		
 		template <typename LUAW_TYPE, typename U, U* LUAW_TYPE::*Member> int get(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			luaWrapper::push<U>(_luaState, obj.get()->*Member);
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			luaWrapper::push<U>(_luaState, obj.*Member);
 			return 1;
 		}
 		
 		template <typename LUAW_TYPE, typename U, U (LUAW_TYPE::*Getter)() const> int get(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			luaWrapper::utils::push<U>(_luaState, (obj.get()->*Getter)());
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			luaWrapper::utils::push<U>(_luaState, (obj.*Getter)());
 			return 1;
 		}
 		
 		template <typename LUAW_TYPE, typename U, const U& (LUAW_TYPE::*Getter)() const> int get(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			luaWrapper::utils::push<U>(_luaState, (obj.get()->*Getter)());
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			luaWrapper::utils::push<U>(_luaState, (obj.*Getter)());
 			return 1;
 		}
 		
 		template <typename LUAW_TYPE, typename U, U* (LUAW_TYPE::*Getter)() const> int get(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			luaWrapper::push<U>(_luaState, (obj.get()->*Getter)());
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			luaWrapper::push<U>(_luaState, (obj.*Getter)());
 			return 1;
 		}
 		
 		template <typename LUAW_TYPE, typename U, U LUAW_TYPE::*Member> int set(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (obj != null) {
-				obj.get()->*Member = luaWrapper::utils::check<U>(_luaState, 2);
-			}
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			obj.*Member = luaWrapper::utils::check<U>(_luaState, 2);
 			return 0;
 		}
 		
 		template <typename LUAW_TYPE, typename U, U* LUAW_TYPE::*Member> int set(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (obj != null) {
-				ememory::SharedPtr<U> member = luaWrapper::opt<U>(_luaState, 2);
-				obj.get()->*Member = member.get();
-			}
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			obj.*Member = luaWrapper::optPointer<U>(_luaState, 2);
 			return 0;
 		}
 		
 		template <typename LUAW_TYPE, typename U, const U* LUAW_TYPE::*Member> int set(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (obj != null) {
-				ememory::SharedPtr<U> member = luaWrapper::opt<U>(_luaState, 2);
-				obj.get()->*Member = member.get();
-			}
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			obj.*Member = luaWrapper::optPointer<U>(_luaState, 2);
 			return 0;
 		}
 		
 		template <typename LUAW_TYPE, typename U, const U* LUAW_TYPE::*Member> int setAndRelease(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (obj != null) {
-				ememory::SharedPtr<U> member = luaWrapper::opt<U>(_luaState, 2);
-				obj.get()->*Member = member.get();
-				if (member) {
-					luaWrapper::release<U>(_luaState, member);
-				}
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			ememory::SharedPtr<U> member = luaWrapper::opt<U>(_luaState, 2);
+			obj.*Member = member.get();
+			if (member) {
+				luaWrapper::release<U>(_luaState, member);
 			}
 			return 0;
 		}
 		
 		template <typename LUAW_TYPE, typename U, void (LUAW_TYPE::*Setter)(U)> int set(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (obj != null) {
-				(obj.get()->*Setter)(luaWrapper::utils::check<U>(_luaState, 2));
-			}
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			(obj.*Setter)(luaWrapper::utils::check<U>(_luaState, 2));
 			return 0;
 		}
 		
 		template <typename LUAW_TYPE, typename U, void (LUAW_TYPE::*Setter)(const U&)> int set(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (obj != null) {
-				(obj.get()->*Setter)(luaWrapper::utils::check<U>(_luaState, 2));
-			}
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			(obj.*Setter)(luaWrapper::utils::check<U>(_luaState, 2));
 			return 0;
 		}
 		
 		template <typename LUAW_TYPE, typename U, void (LUAW_TYPE::*Setter)(U*)> int set(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (obj != null) {
-				ememory::SharedPtr<U> member = luaWrapper::opt<U>(_luaState, 2);
-				(obj.get()->*Setter)(member.get());
-			}
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			(obj.*Setter)(luaWrapper::optPointer<U>(_luaState, 2));
 			return 0;
 		}
 		
 		template <typename LUAW_TYPE, typename U, void (LUAW_TYPE::*Setter)(U*)> int setAndRelease(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (obj != null) {
-				ememory::SharedPtr<U> member = luaWrapper::opt<U>(_luaState, 2);
-				(obj.get()->*Setter)(member);
-				if (member) {
-					luaWrapper::release<U>(_luaState, member);
-				}
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			ememory::SharedPtr<U> member = luaWrapper::opt<U>(_luaState, 2);
+			(obj.*Setter)(member);
+			if (member) {
+				luaWrapper::release<U>(_luaState, member);
 			}
 			return 0;
 		}
 		
 		template <typename LUAW_TYPE, typename U, U LUAW_TYPE::*Member> int getSet(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (    obj != null
-			     && lua_gettop(_luaState) >= 2) {
-				obj.get()->*Member = luaWrapper::utils::check<U>(_luaState, 2);
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			if (lua_gettop(_luaState) >= 2) {
+				obj.*Member = luaWrapper::utils::check<U>(_luaState, 2);
 				return 0;
 			} else {
-				luaWrapper::utils::push<U>(_luaState, obj.get()->*Member);
+				luaWrapper::utils::push<U>(_luaState, obj.*Member);
 				return 1;
 			}
 		}
 		
 		template <typename LUAW_TYPE, typename U, U* LUAW_TYPE::*Member> int getSet(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (    obj != null
-			     && lua_gettop(_luaState) >= 2) {
-				ememory::SharedPtr<U> member = luaWrapper::opt<U>(_luaState, 2);
-				obj.get()->*Member = member.get();
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			if (lua_gettop(_luaState) >= 2) {
+				obj.*Member = luaWrapper::optPointer<U>(_luaState, 2);
 				return 0;
 			} else {
-				luaWrapper::push<U>(_luaState, obj.get()->*Member);
+				luaWrapper::push<U>(_luaState, obj.*Member);
 				return 1;
 			}
 		}
 		
+		/**
+		 * Same as get/set/getSet for a public member of a value type (see
+		 * luaWrapper::registerValue): the object is accessed in place in the
+		 * userdata.
+		 */
+		template <typename LUAW_TYPE, typename U, U LUAW_TYPE::*Member> int getValue(lua_State* _luaState) {
+			LUAW_TYPE& obj = luaWrapper::checkValue<LUAW_TYPE>(_luaState, 1);
+			luaWrapper::utils::push<U>(_luaState, obj.*Member);
+			return 1;
+		}
+		
+		template <typename LUAW_TYPE, typename U, U LUAW_TYPE::*Member> int setValue(lua_State* _luaState) {
+			LUAW_TYPE& obj = luaWrapper::checkValue<LUAW_TYPE>(_luaState, 1);
+			obj.*Member = luaWrapper::utils::check<U>(_luaState, 2);
+			return 0;
+		}
+		
+		template <typename LUAW_TYPE, typename U, U LUAW_TYPE::*Member> int getSetValue(lua_State* _luaState) {
+			LUAW_TYPE& obj = luaWrapper::checkValue<LUAW_TYPE>(_luaState, 1);
+			if (lua_gettop(_luaState) >= 2) {
+				obj.*Member = luaWrapper::utils::check<U>(_luaState, 2);
+				return 0;
+			}
+			luaWrapper::utils::push<U>(_luaState, obj.*Member);
+			return 1;
+		}
+		
 		template <typename LUAW_TYPE, typename U, U* LUAW_TYPE::*Member> int getSetAndRelease(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (    obj != null
-			     && lua_gettop(_luaState) >= 2) {
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			if (lua_gettop(_luaState) >= 2) {
 				ememory::SharedPtr<U> member = luaWrapper::opt<U>(_luaState, 2);
-				obj.get()->*Member = member.get();
+				obj.*Member = member.get();
 				if (member)
 					luaWrapper::release<U>(_luaState, member);
 				return 0;
 			} else {
-				luaWrapper::push<U>(_luaState, obj.get()->*Member);
+				luaWrapper::push<U>(_luaState, obj.*Member);
 				return 1;
 			}
 		}
 		
 		template <typename LUAW_TYPE, typename U, U (LUAW_TYPE::*Getter)() const, void (LUAW_TYPE::*Setter)(U)> int getSet(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (    obj != null
-			     && lua_gettop(_luaState) >= 2) {
-				(obj.get()->*Setter)(luaWrapper::utils::check<U>(_luaState, 2));
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			if (lua_gettop(_luaState) >= 2) {
+				(obj.*Setter)(luaWrapper::utils::check<U>(_luaState, 2));
 				return 0;
 			} else {
-				luaWrapper::utils::push<U>(_luaState, (obj.get()->*Getter)());
+				luaWrapper::utils::push<U>(_luaState, (obj.*Getter)());
 				return 1;
 			}
 		}
 		
 		template <typename LUAW_TYPE, typename U, U (LUAW_TYPE::*Getter)() const, void (LUAW_TYPE::*Setter)(const U&)> int getSet(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (    obj != null
-			     && lua_gettop(_luaState) >= 2) {
-				(obj.get()->*Setter)(luaWrapper::utils::check<U>(_luaState, 2));
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			if (lua_gettop(_luaState) >= 2) {
+				(obj.*Setter)(luaWrapper::utils::check<U>(_luaState, 2));
 				return 0;
 			} else {
-				luaWrapper::utils::push<U>(_luaState, (obj.get()->*Getter)());
+				luaWrapper::utils::push<U>(_luaState, (obj.*Getter)());
 				return 1;
 			}
 		}
 		
 		template <typename LUAW_TYPE, typename U, const U& (LUAW_TYPE::*Getter)() const, void (LUAW_TYPE::*Setter)(const U&)> int getSet(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (    obj != null
-			     && lua_gettop(_luaState) >= 2) {
-				(obj.get()->*Setter)(luaWrapper::utils::check<U>(_luaState, 2));
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			if (lua_gettop(_luaState) >= 2) {
+				(obj.*Setter)(luaWrapper::utils::check<U>(_luaState, 2));
 				return 0;
 			} else {
-				luaWrapper::utils::push<U>(_luaState, (obj.get()->*Getter)());
+				luaWrapper::utils::push<U>(_luaState, (obj.*Getter)());
 				return 1;
 			}
 		}
 		
 		template <typename LUAW_TYPE, typename U, U* (LUAW_TYPE::*Getter)() const, void (LUAW_TYPE::*Setter)(U*)> int getSet(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (    obj != null
-			     && lua_gettop(_luaState) >= 2) {
-				ememory::SharedPtr<U> member = luaWrapper::opt<U>(_luaState, 2);
-				(obj.get()->*Setter)(member.get());
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			if (lua_gettop(_luaState) >= 2) {
+				(obj.*Setter)(luaWrapper::optPointer<U>(_luaState, 2));
 				return 0;
 			} else {
-				luaWrapper::push<U>(_luaState, (obj.get()->*Getter)());
+				luaWrapper::push<U>(_luaState, (obj.*Getter)());
 				return 1;
 			}
 		}
 		
 		template <typename LUAW_TYPE, typename U, U* (LUAW_TYPE::*Getter)() const, void (LUAW_TYPE::*Setter)(U*)> int getSetAndRelease(lua_State* _luaState) {
-			ememory::SharedPtr<LUAW_TYPE> obj = luaWrapper::check<LUAW_TYPE>(_luaState, 1);
-			if (    obj != null
-			     && lua_gettop(_luaState) >= 2) {
+			LUAW_TYPE& obj = luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1);
+			if (lua_gettop(_luaState) >= 2) {
 				ememory::SharedPtr<U> member = luaWrapper::opt<U>(_luaState, 2);
-				(obj.get()->*Setter)(member);
+				(obj.*Setter)(member);
 				if (member)
 					luaWrapper::release<U>(_luaState, member);
 				return 0;
 			} else {
-				luaWrapper::push<U>(_luaState, (obj.get()->*Getter)());
+				luaWrapper::push<U>(_luaState, (obj.*Getter)());
 				return 1;
 			}
 		}
@@ -364,7 +362,7 @@ namespace luaWrapper {
 		 * This macro will expand based on the function signature of Foo::DoSomething
 		 * In this example, it would expand into the following wrapper:
 		 *
-		 *	 luaWrapper::utils::push(luaWrapper::check<T>(L, 1)->doSomething(luaWrapper::utils::check<int>(L, 2), luaWrapper::utils::check<const char*>(L, 3)));
+		 *	 luaWrapper::utils::push(luaWrapper::checkRef<T>(L, 1).doSomething(luaWrapper::utils::check<int>(L, 2), luaWrapper::utils::check<const char*>(L, 3)));
 		 *	 return 1;
 		 *
 		 * In this example there is only one member function called DoSomething. In some
@@ -431,17 +429,6 @@ namespace luaWrapper {
 		#define luaWrapperUtils_staticfunc(func) &luaWrapper::utils::StaticFuncWrapper<decltype(func),func>::call
 		#define luaWrapperUtils_staticfuncsig(returntype, type, funcname, ...) luaWrapperUtilsstaticfunc(static_cast<returntype (*)(__VA_ARGS__)>(&type::funcname))
 		
-		template<int... ints> struct IntPack { };
-		template<int start, int count, int... tail> struct MakeIntRangeType {
-			typedef typename MakeIntRangeType<start, count-1, start+count-1, tail...>::type type;
-		};
-		template<int start, int... tail> struct MakeIntRangeType<start, 0, tail...> {
-			typedef IntPack<tail...> type;
-		};
-		template<int start, int count> inline typename MakeIntRangeType<start, count>::type makeIntRange() {
-			return typename MakeIntRangeType<start, count>::type();
-		}
-		
 		/**
 		 * Member function wrapper
 		 */
@@ -456,7 +443,7 @@ namespace luaWrapper {
 				}
 			private:
 				template<int... indices> static int callImpl(lua_State* _luaState, IntPack<indices...>) {
-					luaWrapper::utils::push<ReturnType>(_luaState, ((*luaWrapper::check<LUAW_TYPE>(_luaState, 1)).*MemberFunc)(luaWrapper::utils::check<typename luaWrapper::utils::remove_cr<Args>::type>(_luaState, indices)...));
+					luaWrapper::utils::push<ReturnType>(_luaState, (luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1).*MemberFunc)(luaWrapper::utils::check<typename luaWrapper::utils::remove_cr<Args>::type>(_luaState, indices)...));
 					return 1;
 				}
 		};
@@ -470,7 +457,7 @@ namespace luaWrapper {
 			private:
 				template<int... indices>
 				static int callImpl(lua_State* _luaState, IntPack<indices...>) {
-					((*luaWrapper::check<LUAW_TYPE>(_luaState, 1)).*MemberFunc)(luaWrapper::utils::check<typename luaWrapper::utils::remove_cr<Args>::type>(_luaState, indices)...);
+					(luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1).*MemberFunc)(luaWrapper::utils::check<typename luaWrapper::utils::remove_cr<Args>::type>(_luaState, indices)...);
 					return 0;
 				}
 		};
@@ -528,7 +515,7 @@ namespace luaWrapper {
 		 * foo2 = foo:clone()
 		 */
 		template <typename LUAW_TYPE> int clone(lua_State* _luaState) {
-			LUAW_TYPE* obj = new LUAW_TYPE(*luaWrapper::check<LUAW_TYPE>(_luaState, 1));
+			LUAW_TYPE* obj = new LUAW_TYPE(luaWrapper::checkRef<LUAW_TYPE>(_luaState, 1));
 			lua_remove(_luaState, 1); // ...
 			int numargs = lua_gettop(_luaState);
 			luaWrapper::push<LUAW_TYPE>(_luaState, obj); // ... clone
@@ -599,7 +586,7 @@ namespace luaWrapper {
 				lua_pushstring(_luaState, _key);
 			} else {
 				// ... store ... obj store.storagetable key
-				LuaWrapper<LUAW_TYPE>::identifier(_luaState, luaWrapper::to<LUAW_TYPE>(_luaState, -2));
+				luaWrapper::pushIdentifier<LUAW_TYPE>(_luaState, luaWrapper::to<LUAW_TYPE>(_luaState, -2));
 			}
 			// ... store ... obj store.storagetable key obj
 			lua_pushvalue(_luaState, -3);
@@ -0,0 +1,41 @@
+#!/usr/bin/python
+import lutin.debug as debug
+import lutin.tools as tools
+
+
+def get_type():
+	return "BINARY"
+
+def get_sub_type():
+	return "TOOL"
+
+def get_name():
+	return "lua-wrapper-bench"
+
+def get_desc():
+	return "lua wrapper micro-benchmark application"
+
+def get_licence():
+	return "MPL-2"
+
+def get_compagny_type():
+	return "com"
+
+def get_compagny_name():
+	return "atria-soft"
+
+def get_maintainer():
+	return ["Mr DUPIN Edouard <yui.heero@gmail.com>"]
+
+def configure(target, my_module):
+	my_module.add_src_file([
+	    'bench/benchmark.cpp',
+	    'bench/main.cpp',
+	    ])
+	my_module.add_depend([
+	    'luaWrapper',
+	    'echrono',
+	    'test-debug'
+	    ])
+	return True
+
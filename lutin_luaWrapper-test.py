@@ -31,6 +31,27 @@ def configure(target, my_module):
 	my_module.add_src_file([
 	    'test/test.cpp',
 	    'test/testCCallLuaFunction.cpp',
+	    'test/testType.cpp',
+	    'test/testLuaFunction.cpp',
+	    'test/testExecute.cpp',
+	    'test/testBytecodeCache.cpp',
+	    'test/testLuaStatePool.cpp',
+	    'test/testRegistry.cpp',
+	    'test/testPoolAllocator.cpp',
+	    'test/testMemoryLimit.cpp',
+	    'test/testAllocationProfiler.cpp',
+	    'test/testValue.cpp',
+	    'test/testBorrowed.cpp',
+	    'test/testSealed.cpp',
+	    'test/testStorage.cpp',
+	    'test/testProperty.cpp',
+	    'test/testContainer.cpp',
+	    'test/testVectorView.cpp',
+	    'test/testNumericArray.cpp',
+	    'test/testStructView.cpp',
+	    'test/testGather.cpp',
+	    'test/testString.cpp',
+	    'test/testSymbol.cpp',
 	    ])
 	my_module.add_depend([
 	    'luaWrapper',
@@ -33,16 +33,31 @@ def configure(target, my_module):
 	my_module.add_extra_flags()
 	my_module.add_depend([
 	    'lua',
-	    'ememory'
+	    'ememory',
+	    'ethread-core'
 	    ])
 	my_module.add_src_file([
 	    'luaWrapper/debug.cpp',
+	    'luaWrapper/AllocationProfiler.cpp',
+	    'luaWrapper/Lua.cpp',
+	    'luaWrapper/LuaStatePool.cpp',
+	    'luaWrapper/PoolAllocator.cpp',
 	    'luaWrapper/luaWrapperEtk.cpp',
+	    'luaWrapper/NumericArray.cpp',
+	    'luaWrapper/StructView.cpp',
+	    'luaWrapper/Symbol.cpp',
 	    ])
 	my_module.add_header_file([
 	    'luaWrapper/debug.hpp',
+	    'luaWrapper/AllocationProfiler.hpp',
 	    'luaWrapper/luaWrapper.hpp',
+	    'luaWrapper/LuaStatePool.hpp',
+	    'luaWrapper/PoolAllocator.hpp',
 	    'luaWrapper/luaWrapperUtil.hpp',
+	    'luaWrapper/VectorView.hpp',
+	    'luaWrapper/NumericArray.hpp',
+	    'luaWrapper/StructView.hpp',
+	    'luaWrapper/Symbol.hpp',
 	    ])
 	return my_module
 
@@ -0,0 +1,94 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <etest/etest.hpp>
+
+namespace testAllocationProfiler {
+	class Element {
+		public:
+			int m_value = 0;
+	};
+}
+ETK_DECLARE_TYPE(testAllocationProfiler::Element);
+
+static luaL_Reg testAllocationProfilerEmpty[] = {
+	{ NULL, NULL }
+};
+
+static const luaWrapper::AllocationSite* findSite(const luaWrapper::Lua& _lua, const etk::String& _name) {
+	for (auto &it: _lua.getAllocationProfiler()->getSites()) {
+		if (it.m_name == _name) {
+			return &it;
+		}
+	}
+	return null;
+}
+
+TEST(TestAllocationProfiler, scriptLine) {
+	luaWrapper::Lua lua;
+	EXPECT_EQ(lua.getAllocationProfiler() == null, true);
+	lua.setAllocationProfiling(true);
+	lua.executeString("local tmp = 0\n"
+	                  "data = {} for iii=1,100 do data[iii] = { iii } end\n"
+	                  "for iii=1,100 do local value = { iii } end\n", "=profile");
+	lua_gc(lua.getState(), LUA_GCCOLLECT, 0);
+	const luaWrapper::AllocationSite* kept = findSite(lua, "profile:2");
+	const luaWrapper::AllocationSite* released = findSite(lua, "profile:3");
+	EXPECT_EQ(kept != null, true);
+	EXPECT_EQ(released != null, true);
+	if (    kept == null
+	     || released == null) {
+		return;
+	}
+	EXPECT_EQ(kept->m_liveCount >= 100, true);
+	EXPECT_EQ(kept->m_totalCount >= 100, true);
+	EXPECT_EQ(released->m_liveCount, 0);
+	EXPECT_EQ(released->m_totalCount >= 100, true);
+	EXPECT_NE(lua.getAllocationReport().find("profile:2"), etk::String::npos);
+	lua.setAllocationProfiling(false);
+	EXPECT_EQ(lua.getAllocationProfiler() == null, true);
+}
+
+TEST(TestAllocationProfiler, boundType) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerElement<testAllocationProfiler::Element>(lua, "Element", NULL, testAllocationProfilerEmpty);
+	lua_settop(lua.getState(), 0);
+	lua.setAllocationProfiling(true);
+	lua.executeString("elements = {}\n"
+	                  "for iii=1,10 do elements[iii] = Element.new() end\n", "=profile");
+	const luaWrapper::AllocationSite* site = findSite(lua, "[Element] profile:2");
+	EXPECT_EQ(site != null, true);
+	if (site == null) {
+		return;
+	}
+	EXPECT_EQ(site->m_liveCount >= 10, true);
+}
+
+TEST(TestAllocationProfiler, stackGrowth) {
+	luaWrapper::Lua lua;
+	lua.setAllocationProfiling(true);
+	// The lua stack is reallocated while the profiler records the allocations.
+	lua.executeString("local function deep(level)\n"
+	                  "  if level == 0 then return { } end\n"
+	                  "  return deep(level - 1), level\n"
+	                  "end\n"
+	                  "result = deep(5000)\n", "=profile");
+	lua_getglobal(lua.getState(), "result");
+	EXPECT_EQ(lua_istable(lua.getState(), -1), 1);
+	EXPECT_EQ(findSite(lua, "profile:2") != null, true);
+}
+
+TEST(TestAllocationProfiler, scopeAfterError) {
+	luaWrapper::Lua lua;
+	lua.setAllocationProfiling(true);
+	// Scope left by a lua error raised (longjmp) during a push.
+	luaWrapper::getContext(lua.getState())->m_allocationScope = "Element";
+	lua.executeString("data = {}\n"
+	                  "for iii=1,10 do data[iii] = { iii } end\n", "=profile");
+	EXPECT_EQ(findSite(lua, "profile:2") != null, true);
+	EXPECT_EQ(findSite(lua, "[Element] profile:2") == null, true);
+}
@@ -0,0 +1,129 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <luaWrapper/luaWrapperUtil.hpp>
+#include <etest/etest.hpp>
+
+namespace testBorrowed {
+	class Element {
+		public:
+			int m_value = 0;
+			Element(int _value = 0) :
+			  m_value(_value) {
+
+			}
+			void add(int _value) {
+				m_value += _value;
+			}
+	};
+	class Other {
+		public:
+			int m_value = 0;
+	};
+}
+ETK_DECLARE_TYPE(testBorrowed::Element);
+ETK_DECLARE_TYPE(testBorrowed::Other);
+
+static luaL_Reg testBorrowedElement[] = {
+	{ "value", luaWrapper::utils::getSet<testBorrowed::Element, int, &testBorrowed::Element::m_value> },
+	{ "add", luaWrapperUtils_func(&testBorrowed::Element::add) },
+	{ NULL, NULL }
+};
+
+static luaL_Reg testBorrowedEmpty[] = {
+	{ NULL, NULL }
+};
+
+TEST(TestBorrowed, checkRef) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerElement<testBorrowed::Element>(lua, "Element", NULL, testBorrowedElement);
+	luaWrapper::registerElement<testBorrowed::Other>(lua, "Other", NULL, testBorrowedEmpty);
+	lua_settop(lua.getState(), 0);
+	ememory::SharedPtr<testBorrowed::Element> element = ememory::makeShared<testBorrowed::Element>(42);
+	luaWrapper::push<testBorrowed::Element>(lua.getState(), element);
+	// The reference is the object held by the userdata.
+	EXPECT_EQ(&luaWrapper::checkRef<testBorrowed::Element>(lua.getState(), -1), element.get());
+	EXPECT_EQ(luaWrapper::toPointer<testBorrowed::Element>(lua.getState(), -1), element.get());
+	EXPECT_EQ(luaWrapper::toPointer<testBorrowed::Other>(lua.getState(), -1) == null, true);
+	lua_pushnil(lua.getState());
+	EXPECT_EQ(luaWrapper::optPointer<testBorrowed::Element>(lua.getState(), -1) == null, true);
+}
+
+TEST(TestBorrowed, wrappers) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerElement<testBorrowed::Element>(lua, "Element", NULL, testBorrowedElement);
+	luaWrapper::registerElement<testBorrowed::Other>(lua, "Other", NULL, testBorrowedEmpty);
+	lua_settop(lua.getState(), 0);
+	lua.executeString("element = Element.new()\n"
+	                  "element:value(5)\n"
+	                  "element:add(3)\n"
+	                  "result = element:value()\n"
+	                  "ok = pcall(element.value, Other.new())\n");
+	lua_getglobal(lua.getState(), "result");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 8);
+	// A value of another type raise an error (not a crash).
+	lua_getglobal(lua.getState(), "ok");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+}
+
+TEST(TestBorrowed, pushBorrowed) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerElement<testBorrowed::Element>(lua, "Element", NULL, testBorrowedElement);
+	lua_settop(lua.getState(), 0);
+	testBorrowed::Element element(5);
+	uint32_t generation = 0;
+	luaWrapper::pushBorrowed<testBorrowed::Element>(lua.getState(), &element, &generation);
+	lua_setglobal(lua.getState(), "element");
+	lua.executeString("element:add(3)");
+	EXPECT_EQ(element.m_value, 8);
+	// Same object: same userdata.
+	luaWrapper::pushBorrowed<testBorrowed::Element>(lua.getState(), &element, &generation);
+	lua_getglobal(lua.getState(), "element");
+	EXPECT_EQ(lua_rawequal(lua.getState(), -1, -2), 1);
+	EXPECT_EQ(luaWrapper::toPointer<testBorrowed::Element>(lua.getState(), -1), &element);
+	// A borrowed object is not shared.
+	EXPECT_EQ(luaWrapper::to<testBorrowed::Element>(lua.getState(), -1) == null, true);
+}
+
+TEST(TestBorrowed, destroyed) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerElement<testBorrowed::Element>(lua, "Element", NULL, testBorrowedElement);
+	lua_settop(lua.getState(), 0);
+	testBorrowed::Element element(5);
+	uint32_t generation = 0;
+	luaWrapper::pushBorrowed<testBorrowed::Element>(lua.getState(), &element, &generation);
+	lua_setglobal(lua.getState(), "element");
+	// The application destroy the object.
+	generation++;
+	lua.executeString("ok = pcall(element.add, element, 3)");
+	lua_getglobal(lua.getState(), "ok");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+	EXPECT_EQ(element.m_value, 5);
+	lua_getglobal(lua.getState(), "element");
+	EXPECT_EQ(luaWrapper::toPointer<testBorrowed::Element>(lua.getState(), -1) == null, true);
+	// A new object in the same slot get a new userdata.
+	luaWrapper::pushBorrowed<testBorrowed::Element>(lua.getState(), &element, &generation);
+	EXPECT_EQ(lua_rawequal(lua.getState(), -1, -2), 0);
+	EXPECT_EQ(luaWrapper::toPointer<testBorrowed::Element>(lua.getState(), -1), &element);
+}
+
+TEST(TestBorrowed, sameAddress) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerElement<testBorrowed::Element>(lua, "Element", NULL, testBorrowedElement);
+	lua_settop(lua.getState(), 0);
+	ememory::SharedPtr<testBorrowed::Element> element = ememory::makeShared<testBorrowed::Element>(5);
+	uint32_t generation = 0;
+	// A borrowed userdata of a destroyed object at the address of the new shared object.
+	luaWrapper::pushBorrowed<testBorrowed::Element>(lua.getState(), element.get(), &generation);
+	generation++;
+	// push does not return the borrowed userdata.
+	luaWrapper::push<testBorrowed::Element>(lua.getState(), element);
+	EXPECT_EQ(lua_rawequal(lua.getState(), -1, -2), 0);
+	EXPECT_EQ(luaWrapper::to<testBorrowed::Element>(lua.getState(), -1) == element, true);
+	luaWrapper::push<testBorrowed::Element>(lua.getState(), element);
+	EXPECT_EQ(lua_rawequal(lua.getState(), -1, -2), 1);
+}
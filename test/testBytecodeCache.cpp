@@ -0,0 +1,126 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <etk/os/FSNode.hpp>
+#include <etest/etest.hpp>
+#include <chrono>
+
+namespace testBytecodeCache {
+	/**
+	 * Folder unique for each run (the cache of a previous run is not used).
+	 */
+	etk::String getFolder(const etk::String& _name) {
+		return "CACHE:luaWrapperTest/bytecode-" + _name + "-" + etk::toString(std::chrono::steady_clock::now().time_since_epoch().count());
+	}
+	/**
+	 * Name of the stripped cache file of a source (see Lua::setBytecodeCache).
+	 */
+	etk::String getStrippedCacheName(const etk::String& _folder, const etk::String& _source) {
+		uint64_t hash = 14695981039346656037ULL;
+		for (size_t iii=0; iii<_source.size(); ++iii) {
+			hash ^= uint8_t(_source[iii]);
+			hash *= 1099511628211ULL;
+		}
+		static const char* digit = "0123456789abcdef";
+		etk::String out = _folder + "/";
+		for (int32_t iii=60; iii>=0; iii-=4) {
+			out += digit[(hash >> iii) & 0xF];
+		}
+		return out + "-" + etk::toString(LUA_VERSION_NUM) + "-s.luac";
+	}
+	/**
+	 * Execute the file and get the "line" global: 1 when the chunk is compiled
+	 * from the source, -1 when it is loaded from the stripped cache.
+	 */
+	int64_t executeLine(luaWrapper::Lua& _lua, const etk::String& _fileName) {
+		lua_pushnil(_lua.getState());
+		lua_setglobal(_lua.getState(), "line");
+		_lua.executeFile(_fileName);
+		lua_getglobal(_lua.getState(), "line");
+		int64_t out = lua_isnil(_lua.getState(), -1) ? 0 : lua_tointeger(_lua.getState(), -1);
+		lua_pop(_lua.getState(), 1);
+		return out;
+	}
+	const etk::String g_source = "line = debug.getinfo(1, 'l').currentline\n";
+}
+
+TEST(TestBytecodeCache, storeAndHit) {
+	etk::String folder = testBytecodeCache::getFolder("hit");
+	etk::String fileName = folder + "/script.lua";
+	etk::FSNodeWriteAllData(fileName, testBytecodeCache::g_source);
+	luaWrapper::Lua lua;
+	lua.setBytecodeCache(folder, true);
+	// Miss: compiled from the source, then stored.
+	EXPECT_EQ(testBytecodeCache::executeLine(lua, fileName), 1);
+	EXPECT_EQ(etk::FSNodeExist(testBytecodeCache::getStrippedCacheName(folder, testBytecodeCache::g_source)), true);
+	// Hit: the stripped chunk has no line information.
+	EXPECT_EQ(testBytecodeCache::executeLine(lua, fileName), -1);
+	luaWrapper::Lua other;
+	other.setBytecodeCache(folder, true);
+	EXPECT_EQ(testBytecodeCache::executeLine(other, fileName), -1);
+	// Without strip, the stripped entry is not used.
+	luaWrapper::Lua full;
+	full.setBytecodeCache(folder, false);
+	EXPECT_EQ(testBytecodeCache::executeLine(full, fileName), 1);
+	EXPECT_EQ(testBytecodeCache::executeLine(full, fileName), 1);
+}
+
+TEST(TestBytecodeCache, invalidFile) {
+	etk::String folder = testBytecodeCache::getFolder("invalid");
+	etk::String fileName = folder + "/script.lua";
+	etk::String cacheName = testBytecodeCache::getStrippedCacheName(folder, testBytecodeCache::g_source);
+	etk::FSNodeWriteAllData(fileName, testBytecodeCache::g_source);
+	luaWrapper::Lua lua;
+	lua.setBytecodeCache(folder, true);
+	EXPECT_EQ(testBytecodeCache::executeLine(lua, fileName), 1);
+	// Truncated file: the source is used and the entry is written again.
+	etk::FSNodeWriteAllData(cacheName, "LUAWBC");
+	EXPECT_EQ(testBytecodeCache::executeLine(lua, fileName), 1);
+	EXPECT_EQ(testBytecodeCache::executeLine(lua, fileName), -1);
+	// Header that does not match (magic, version...).
+	etk::String header;
+	for (int iii=0; iii<128; ++iii) {
+		header += 'x';
+	}
+	etk::FSNodeWriteAllData(cacheName, header);
+	EXPECT_EQ(testBytecodeCache::executeLine(lua, fileName), 1);
+	EXPECT_EQ(testBytecodeCache::executeLine(lua, fileName), -1);
+}
+
+TEST(TestBytecodeCache, sourceChanged) {
+	etk::String folder = testBytecodeCache::getFolder("changed");
+	etk::String fileName = folder + "/script.lua";
+	etk::FSNodeWriteAllData(fileName, "value = 1\n" + testBytecodeCache::g_source);
+	luaWrapper::Lua lua;
+	lua.setBytecodeCache(folder, true);
+	testBytecodeCache::executeLine(lua, fileName);
+	EXPECT_EQ(testBytecodeCache::executeLine(lua, fileName), -1);
+	// A new content is a new entry.
+	etk::FSNodeWriteAllData(fileName, "value = 2\n" + testBytecodeCache::g_source);
+	EXPECT_EQ(testBytecodeCache::executeLine(lua, fileName), 2);
+	lua_getglobal(lua.getState(), "value");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 2);
+}
+
+TEST(TestBytecodeCache, chunkName) {
+	etk::String folder = testBytecodeCache::getFolder("name");
+	etk::String source = "source = debug.getinfo(1, 'S').source\n";
+	etk::FSNodeWriteAllData(folder + "/first.lua", source);
+	etk::FSNodeWriteAllData(folder + "/second.lua", source);
+	luaWrapper::Lua lua;
+	lua.setBytecodeCache(folder, false);
+	// Same content, the debug information keep the name of each file.
+	for (int iii=0; iii<2; ++iii) {
+		lua.executeFile(folder + "/first.lua");
+		lua_getglobal(lua.getState(), "source");
+		EXPECT_EQ(etk::String(lua_tostring(lua.getState(), -1)), "@" + folder + "/first.lua");
+		lua.executeFile(folder + "/second.lua");
+		lua_getglobal(lua.getState(), "source");
+		EXPECT_EQ(etk::String(lua_tostring(lua.getState(), -1)), "@" + folder + "/second.lua");
+		lua_settop(lua.getState(), 0);
+	}
+}
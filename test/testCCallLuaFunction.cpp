@@ -79,3 +79,60 @@ TEST(TestCCallLuaFunctionn, basicCallNotExist) {
 }
 
 
+
+TEST(TestCCallLuaFunctionn, multipleReturnTuple) {
+	luaWrapper::Lua lua;
+	lua.executeString(R"#(
+	function MyFunctionName(x, y)
+		return x + y, x * y, x > y
+	end
+	)#");
+	std::tuple<int, int, bool> ret = lua.call<std::tuple<int, int, bool>>("MyFunctionName", 6, 7);
+	EXPECT_EQ(std::get<0>(ret), 13);
+	EXPECT_EQ(std::get<1>(ret), 42);
+	EXPECT_EQ(std::get<2>(ret), false);
+	ret = lua.callMultiple<int, int, bool>("MyFunctionName", 7, 6);
+	EXPECT_EQ(std::get<0>(ret), 13);
+	EXPECT_EQ(std::get<1>(ret), 42);
+	EXPECT_EQ(std::get<2>(ret), true);
+	EXPECT_EQ(lua_gettop(lua.getState()), 0);
+}
+
+TEST(TestCCallLuaFunctionn, multipleReturnPair) {
+	luaWrapper::Lua lua;
+	lua.executeString(R"#(
+	function MyFunctionName(x)
+		return x, x * 2
+	end
+	)#");
+	etk::Pair<float, double> ret = lua.call<etk::Pair<float, double>>("MyFunctionName", 21);
+	EXPECT_EQ(ret.first, 21.0f);
+	EXPECT_EQ(ret.second, 42.0);
+	EXPECT_EQ(lua_gettop(lua.getState()), 0);
+}
+
+namespace {
+	struct Position {
+		float x;
+		float y;
+		float z;
+	};
+}
+template<> struct luaWrapper::CallReturn<Position> : luaWrapper::CallReturnStruct<Position, float, float, float> {};
+
+TEST(TestCCallLuaFunctionn, multipleReturnStruct) {
+	luaWrapper::Lua lua;
+	lua.executeString(R"#(
+	function MyFunctionName(x)
+		return x, x * 2, x * 3
+	end
+	)#");
+	Position ret = lua.call<Position>("MyFunctionName", 2);
+	EXPECT_EQ(ret.x, 2.0f);
+	EXPECT_EQ(ret.y, 4.0f);
+	EXPECT_EQ(ret.z, 6.0f);
+	luaWrapper::LuaFunction<Position(int)> function = lua.getFunction<Position(int)>("MyFunctionName");
+	ret = function(3);
+	EXPECT_EQ(ret.z, 9.0f);
+	EXPECT_EQ(lua_gettop(lua.getState()), 0);
+}
@@ -0,0 +1,131 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <etest/etest.hpp>
+
+TEST(TestContainer, vector) {
+	luaWrapper::Lua lua;
+	lua.executeString(R"#(
+	function double(list)
+		local out = {}
+		for iii=1,#list do
+			out[iii] = list[iii]*2
+		end
+		return out
+	end
+	)#");
+	etk::Vector<int> list;
+	for (int iii=0; iii<1000; ++iii) {
+		list.pushBack(iii);
+	}
+	etk::Vector<int> ret = lua.call<etk::Vector<int>>("double", list);
+	EXPECT_EQ(ret.size(), size_t(1000));
+	EXPECT_EQ(ret[0], 0);
+	EXPECT_EQ(ret[999], 1998);
+}
+
+TEST(TestContainer, vectorString) {
+	luaWrapper::Lua lua;
+	lua_State* luaState = lua.getState();
+	etk::Vector<etk::String> list;
+	list.pushBack("hello");
+	list.pushBack("world");
+	luaWrapper::utils::push<etk::Vector<etk::String>>(luaState, list);
+	EXPECT_EQ(lua_rawlen(luaState, -1), size_t(2));
+	etk::Vector<etk::String> ret = luaWrapper::utils::check<etk::Vector<etk::String>>(luaState, -1);
+	EXPECT_EQ(ret.size(), size_t(2));
+	EXPECT_EQ(ret[1], "world");
+	// Not a table: empty vector.
+	lua_pushinteger(luaState, 42);
+	EXPECT_EQ(luaWrapper::utils::to<etk::Vector<etk::String>>(luaState, -1).size(), size_t(0));
+}
+
+TEST(TestContainer, map) {
+	luaWrapper::Lua lua;
+	lua.executeString(R"#(
+	function merge(values)
+		values.c = values.a + values.b
+		return values
+	end
+	)#");
+	etk::Map<etk::String, int> values;
+	values.add("a", 1);
+	values.add("b", 2);
+	etk::Map<etk::String, int> ret = lua.call<etk::Map<etk::String, int>>("merge", values);
+	EXPECT_EQ(ret.size(), size_t(3));
+	EXPECT_EQ(ret["c"], 3);
+}
+
+TEST(TestContainer, mapNumberKey) {
+	luaWrapper::Lua lua;
+	lua_State* luaState = lua.getState();
+	lua.executeString("values = { 'a', 'b', 'c', [10] = 'd' }");
+	lua_getglobal(luaState, "values");
+	// The number keys are converted in string without breaking the iteration.
+	etk::Map<etk::String, etk::String> ret = luaWrapper::utils::check<etk::Map<etk::String, etk::String>>(luaState, -1);
+	EXPECT_EQ(ret.size(), size_t(4));
+	EXPECT_EQ(ret["10"], "d");
+}
+
+TEST(TestContainer, pair) {
+	luaWrapper::Lua lua;
+	lua_State* luaState = lua.getState();
+	luaWrapper::utils::push<etk::Pair<etk::String, float>>(luaState, etk::Pair<etk::String, float>("x", 1.5f));
+	lua_rawgeti(luaState, -1, 1);
+	EXPECT_EQ(etk::String(lua_tostring(luaState, -1)), "x");
+	lua_pop(luaState, 1);
+	etk::Pair<etk::String, float> ret = luaWrapper::utils::check<etk::Pair<etk::String, float>>(luaState, -1);
+	EXPECT_EQ(ret.first, "x");
+	EXPECT_EQ(ret.second, 1.5f);
+}
+
+static int testContainerVector(lua_State* _luaState) {
+	luaWrapper::utils::check<etk::Vector<int>>(_luaState, 2);
+	return 0;
+}
+
+static int testContainerMap(lua_State* _luaState) {
+	luaWrapper::utils::check<etk::Map<etk::String, float>>(_luaState, 1);
+	return 0;
+}
+
+static int testContainerPair(lua_State* _luaState) {
+	luaWrapper::utils::check<etk::Pair<etk::String, float>>(_luaState, 1);
+	return 0;
+}
+
+TEST(TestContainer, badElement) {
+	luaWrapper::Lua lua;
+	lua_State* luaState = lua.getState();
+	lua_register(luaState, "checkVector", testContainerVector);
+	lua_register(luaState, "checkMap", testContainerMap);
+	lua_register(luaState, "checkPair", testContainerPair);
+	lua.executeString("okVector, errorVector = pcall(checkVector, 0, { 1, 'x', 3 })\n"
+	                  "okMap, errorMap = pcall(checkMap, { a = 1.5, b = {} })\n"
+	                  "okKey, errorKey = pcall(checkMap, { a = 1.5, [true] = 2 })\n"
+	                  "okPair, errorPair = pcall(checkPair, { 'x', 'y' })\n"
+	                  "okGood = pcall(checkVector, 0, { 1, '2', 3.0 })\n");
+	lua_getglobal(luaState, "okVector");
+	EXPECT_EQ(lua_toboolean(luaState, -1), 0);
+	lua_getglobal(luaState, "errorVector");
+	EXPECT_NE(etk::String(lua_tostring(luaState, -1)).find("bad argument #2 (integer expected for the element 2, got string)"), etk::String::npos);
+	lua_getglobal(luaState, "okMap");
+	EXPECT_EQ(lua_toboolean(luaState, -1), 0);
+	lua_getglobal(luaState, "errorMap");
+	EXPECT_NE(etk::String(lua_tostring(luaState, -1)).find("bad argument #1 (number expected for the element 'b', got table)"), etk::String::npos);
+	lua_getglobal(luaState, "okKey");
+	EXPECT_EQ(lua_toboolean(luaState, -1), 0);
+	lua_getglobal(luaState, "errorKey");
+	EXPECT_NE(etk::String(lua_tostring(luaState, -1)).find("string expected for a key, got boolean"), etk::String::npos);
+	lua_getglobal(luaState, "okPair");
+	EXPECT_EQ(lua_toboolean(luaState, -1), 0);
+	lua_getglobal(luaState, "errorPair");
+	EXPECT_NE(etk::String(lua_tostring(luaState, -1)).find("number expected for the element 2, got string"), etk::String::npos);
+	// The values converted by lua are accepted.
+	lua_getglobal(luaState, "okGood");
+	EXPECT_EQ(lua_toboolean(luaState, -1), 1);
+}
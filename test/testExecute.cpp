@@ -0,0 +1,106 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <etk/os/FSNode.hpp>
+#include <etest/etest.hpp>
+#include <chrono>
+
+
+TEST(TestExecute, bufferLength) {
+	luaWrapper::Lua lua;
+	const char* data = "value = 42 this is not lua";
+	lua.executeBuffer(data, 10);
+	lua.executeString("function getValue() return value end");
+	EXPECT_EQ(lua.call<int>("getValue"), 42);
+	EXPECT_EQ(lua_gettop(lua.getState()), 0);
+}
+
+TEST(TestExecute, chunkName) {
+	luaWrapper::Lua lua;
+	lua.executeString("function getSource() return debug.getinfo(1, 'S').source end", "=myChunk");
+	EXPECT_EQ(lua.call<etk::String>("getSource"), "=myChunk");
+}
+
+TEST(TestExecute, error) {
+	luaWrapper::Lua lua;
+	lua.executeString("this is not lua");
+	lua.executeString("error('runtime error')");
+	EXPECT_EQ(lua_gettop(lua.getState()), 0);
+}
+
+static int testExecuteWriter(lua_State* _luaState, const void* _data, size_t _size, void* _userData) {
+	etk::Vector<char>* buffer = static_cast<etk::Vector<char>*>(_userData);
+	for (size_t iii=0; iii<_size; ++iii) {
+		buffer->pushBack(static_cast<const char*>(_data)[iii]);
+	}
+	return 0;
+}
+
+TEST(TestExecute, rejectBytecode) {
+	luaWrapper::Lua lua;
+	etk::Vector<char> bytecode;
+	luaL_loadstring(lua.getState(), "value = 7");
+	lua_dump(lua.getState(), testExecuteWriter, &bytecode, 0);
+	lua_pop(lua.getState(), 1);
+	// A precompiled chunk is not loaded.
+	lua.executeBuffer(&bytecode[0], bytecode.size());
+	lua_getglobal(lua.getState(), "value");
+	EXPECT_EQ(lua_isnil(lua.getState(), -1), 1);
+	lua_pop(lua.getState(), 1);
+	EXPECT_EQ(lua_gettop(lua.getState()), 0);
+}
+
+static etk::String testExecuteFolder() {
+	return "CACHE:luaWrapperTest/execute-" + etk::toString(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+TEST(TestExecute, fileBlocks) {
+	etk::String fileName = testExecuteFolder() + "/big.lua";
+	// More than 3 blocks of 64KB, with lines and tokens across the block limits.
+	etk::String source = "total = 0\n";
+	int32_t count = 0;
+	while (source.size() < 200*1024) {
+		source += "total = total + " + etk::toString(count % 7) + " -- padding of the line " + etk::toString(count) + "\n";
+		count++;
+	}
+	source += "lastLine = debug.getinfo(1, 'l').currentline\n";
+	etk::FSNodeWriteAllData(fileName, source);
+	int64_t total = 0;
+	for (int32_t iii=0; iii<count; ++iii) {
+		total += iii % 7;
+	}
+	luaWrapper::Lua lua;
+	lua.executeFile(fileName);
+	lua_getglobal(lua.getState(), "total");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), total);
+	lua_getglobal(lua.getState(), "lastLine");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), count + 2);
+	lua_settop(lua.getState(), 0);
+}
+
+TEST(TestExecute, fileChunkName) {
+	etk::String fileName = testExecuteFolder() + "/error.lua";
+	etk::FSNodeWriteAllData(fileName, "function fail()\n"
+	                                  "  error('failure')\n"
+	                                  "end\n");
+	luaWrapper::Lua lua;
+	lua.executeFile(fileName);
+	lua.executeString("ok, message = pcall(fail)");
+	lua_getglobal(lua.getState(), "message");
+	// The chunk name is "@<fileName>": lua reports the file name and the line.
+	EXPECT_NE(etk::String(lua_tostring(lua.getState(), -1)).find("error.lua:2: failure"), etk::String::npos);
+	lua_settop(lua.getState(), 0);
+}
+
+TEST(TestExecute, fileMissing) {
+	luaWrapper::Lua lua;
+	lua.executeFile(testExecuteFolder() + "/missing.lua");
+	EXPECT_EQ(lua_gettop(lua.getState()), 0);
+	lua.executeString("value = 3");
+	lua_getglobal(lua.getState(), "value");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 3);
+}
@@ -0,0 +1,91 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <luaWrapper/luaWrapperUtil.hpp>
+#include <luaWrapper/NumericArray.hpp>
+#include <etest/etest.hpp>
+
+namespace testGather {
+	class Element {
+		public:
+			int m_value = 0;
+			int getDouble() const {
+				return m_value*2;
+			}
+	};
+}
+ETK_DECLARE_TYPE(testGather::Element);
+
+static luaL_Reg testGatherTable[] = {
+	{ "gather", luaWrapper::gather<testGather::Element> },
+	{ "scatter", luaWrapper::scatter<testGather::Element> },
+	{ NULL, NULL }
+};
+
+static luaL_Reg testGatherEmpty[] = {
+	{ NULL, NULL }
+};
+
+static luaWrapper::Property testGatherElement[] = {
+	{ "value", luaWrapper::utils::get<testGather::Element, int, &testGather::Element::m_value>, luaWrapper::utils::set<testGather::Element, int, &testGather::Element::m_value> },
+	{ "double", luaWrapper::utils::get<testGather::Element, int, &testGather::Element::getDouble>, NULL },
+	{ NULL, NULL, NULL }
+};
+
+static void testGatherInit(luaWrapper::Lua& _lua) {
+	luaWrapper::registerElement<testGather::Element>(_lua, "Element", testGatherTable, testGatherEmpty);
+	luaWrapper::setProperties<testGather::Element>(_lua.getState(), testGatherElement);
+	luaWrapper::registerNumericArrays(_lua);
+	lua_settop(_lua.getState(), 0);
+	_lua.executeString("list = {}\n"
+	                  "for i=1,5 do\n"
+	                  "  list[i] = Element.new()\n"
+	                  "  list[i].value = i\n"
+	                  "end\n");
+}
+
+TEST(TestGather, gather) {
+	luaWrapper::Lua lua;
+	testGatherInit(lua);
+	lua.executeString("local values = Element.gather(list, 'double')\n"
+	                  "size = #values\n"
+	                  "last = values[5]\n"
+	                  "local array = Element.gather(list, 'value', Int32Array.new(5))\n"
+	                  "sum = array:sum()\n"
+	                  "okName = pcall(Element.gather, list, 'unknown')\n"
+	                  "okType = pcall(Element.gather, {1, 2}, 'value')\n");
+	lua_getglobal(lua.getState(), "size");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 5);
+	lua_getglobal(lua.getState(), "last");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 10);
+	lua_getglobal(lua.getState(), "sum");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 15);
+	lua_getglobal(lua.getState(), "okName");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+	lua_getglobal(lua.getState(), "okType");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+}
+
+TEST(TestGather, scatter) {
+	luaWrapper::Lua lua;
+	testGatherInit(lua);
+	lua.executeString("Element.scatter(list, 'value', {5, 4, 3, 2, 1})\n"
+	                  "first = list[1].value\n"
+	                  "Element.scatter(list, 'value', Int32Array.new({7, 7, 7, 7, 9}))\n"
+	                  "last = list[5].value\n"
+	                  "Element.scatter(list, 'value', 3)\n"
+	                  "third = list[3].value\n"
+	                  "okReadOnly = pcall(Element.scatter, list, 'double', 1)\n");
+	lua_getglobal(lua.getState(), "first");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 5);
+	lua_getglobal(lua.getState(), "last");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 9);
+	lua_getglobal(lua.getState(), "third");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 3);
+	lua_getglobal(lua.getState(), "okReadOnly");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+}
@@ -0,0 +1,84 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <etest/etest.hpp>
+
+
+TEST(TestLuaFunction, callGlobal) {
+	luaWrapper::Lua lua;
+	lua.executeString(R"#(
+	function MyFunctionName(x, y)
+		return x + y*2
+	end
+	)#");
+	luaWrapper::LuaFunction<int(int, int)> function = lua.getFunction<int(int, int)>("MyFunctionName");
+	EXPECT_EQ(function.isValid(), true);
+	EXPECT_EQ(function(43, 76), 43 + 76 * 2);
+	int value = 12;
+	EXPECT_EQ(function(value, value), 12 + 12 * 2);
+	EXPECT_EQ(lua_gettop(lua.getState()), 0);
+}
+
+TEST(TestLuaFunction, callNested) {
+	luaWrapper::Lua lua;
+	lua.executeString(R"#(
+	ai = { brain = {} }
+	function ai.brain.update(x)
+		return x * 3
+	end
+	)#");
+	luaWrapper::LuaFunction<double(double)> function = lua.getFunction<double(double)>("ai.brain.update");
+	EXPECT_EQ(function.isValid(), true);
+	EXPECT_EQ(function(2.5), 7.5);
+	// The handle is not affected if the path is modified.
+	lua.executeString("ai = nil");
+	EXPECT_EQ(function(2.0), 6.0);
+}
+
+TEST(TestLuaFunction, callVoid) {
+	luaWrapper::Lua lua;
+	lua.executeString(R"#(
+	counter = 0
+	function increment(x)
+		counter = counter + x
+	end
+	function getCounter()
+		return counter
+	end
+	)#");
+	luaWrapper::LuaFunction<void(int)> function = lua.getFunction<void(int)>("increment");
+	for (int32_t iii=0; iii<10; ++iii) {
+		function(2);
+	}
+	EXPECT_EQ(lua.call<int>("getCounter"), 20);
+	EXPECT_EQ(lua_gettop(lua.getState()), 0);
+}
+
+TEST(TestLuaFunction, copy) {
+	luaWrapper::Lua lua;
+	lua.executeString(R"#(
+	function double(x)
+		return x * 2
+	end
+	)#");
+	luaWrapper::LuaFunction<int(int)> function;
+	EXPECT_EQ(function.isValid(), false);
+	{
+		luaWrapper::LuaFunction<int(int)> tmp = lua.getFunction<int(int)>("double");
+		function = tmp;
+	}
+	EXPECT_EQ(function(21), 42);
+}
+
+TEST(TestLuaFunction, notExist) {
+	luaWrapper::Lua lua;
+	luaWrapper::LuaFunction<void(int)> function = lua.getFunction<void(int)>("ai.notExist");
+	EXPECT_EQ(function.isValid(), false);
+	EXPECT_THROW(function(2), etk::exception::RuntimeError);
+	luaWrapper::LuaFunction<void()> function2 = lua.getFunction<void()>("");
+	EXPECT_EQ(function2.isValid(), false);
+}
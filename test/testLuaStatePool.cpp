@@ -0,0 +1,151 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/LuaStatePool.hpp>
+#include <etest/etest.hpp>
+#include <atomic>
+#include <thread>
+
+static void testPoolSetup(luaWrapper::Lua& _lua) {
+	_lua.executeString("counter = 0\n"
+	                   "function increment() counter = counter + 1 return counter end");
+}
+
+TEST(TestLuaStatePool, setup) {
+	luaWrapper::LuaStatePool pool(2, testPoolSetup);
+	EXPECT_EQ(pool.size(), 2);
+	luaWrapper::LuaStatePool::Checkout lua1 = pool.checkout();
+	luaWrapper::LuaStatePool::Checkout lua2 = pool.checkout();
+	EXPECT_EQ(lua1.isValid(), true);
+	EXPECT_EQ(lua2.isValid(), true);
+	EXPECT_NE(lua1.get(), lua2.get());
+	EXPECT_EQ(lua1->call<int>("increment"), 1);
+	EXPECT_EQ(lua2->call<int>("increment"), 1);
+}
+
+TEST(TestLuaStatePool, exhausted) {
+	luaWrapper::LuaStatePool pool(1, testPoolSetup);
+	luaWrapper::LuaStatePool::Checkout lua1 = pool.checkout();
+	luaWrapper::LuaStatePool::Checkout lua2 = pool.tryCheckout(1000);
+	EXPECT_EQ(lua2.isValid(), false);
+	luaWrapper::Lua* state = lua1.get();
+	lua1.checkin();
+	EXPECT_EQ(lua1.isValid(), false);
+	luaWrapper::LuaStatePool::Checkout lua3 = pool.tryCheckout(1000);
+	EXPECT_EQ(lua3.isValid(), true);
+	EXPECT_EQ(lua3.get(), state);
+}
+
+TEST(TestLuaStatePool, cleanStack) {
+	luaWrapper::LuaStatePool pool(1, testPoolSetup);
+	{
+		luaWrapper::LuaStatePool::Checkout lua = pool.checkout();
+		lua->executeString("return 1, 2, 3");
+		EXPECT_EQ(lua_gettop(lua->getState()), 3);
+	}
+	luaWrapper::LuaStatePool::Checkout lua = pool.checkout();
+	EXPECT_EQ(lua_gettop(lua->getState()), 0);
+}
+
+TEST(TestLuaStatePool, pinned) {
+	luaWrapper::LuaStatePool pool(2, testPoolSetup);
+	luaWrapper::Lua* state = null;
+	{
+		luaWrapper::LuaStatePool::Checkout lua = pool.checkoutPinned();
+		state = lua.get();
+		EXPECT_EQ(lua->call<int>("increment"), 1);
+	}
+	{
+		// The pinned state is not given to the other checkouts.
+		luaWrapper::LuaStatePool::Checkout lua = pool.checkout();
+		EXPECT_NE(lua.get(), state);
+		EXPECT_EQ(pool.tryCheckout(1000).isValid(), false);
+	}
+	{
+		luaWrapper::LuaStatePool::Checkout lua = pool.checkoutPinned();
+		EXPECT_EQ(lua.get(), state);
+		EXPECT_EQ(lua->call<int>("increment"), 2);
+	}
+	pool.unpin();
+	luaWrapper::LuaStatePool::Checkout lua1 = pool.checkout();
+	luaWrapper::LuaStatePool::Checkout lua2 = pool.checkout();
+	EXPECT_EQ(lua1.isValid(), true);
+	EXPECT_EQ(lua2.isValid(), true);
+}
+
+TEST(TestLuaStatePool, concurrent) {
+	const size_t nbThread = 8;
+	const size_t nbJob = 200;
+	luaWrapper::LuaStatePool pool(3, testPoolSetup);
+	std::atomic<int> total(0);
+	std::atomic<int> error(0);
+	etk::Vector<std::thread> threads;
+	for (size_t iii=0; iii<nbThread; ++iii) {
+		threads.pushBack(std::thread([&]() {
+			for (size_t jjj=0; jjj<nbJob; ++jjj) {
+				luaWrapper::LuaStatePool::Checkout lua = pool.checkout();
+				// The stack is empty: no other thread use the state at the same time.
+				if (lua_gettop(lua->getState()) != 0) {
+					error++;
+				}
+				lua_pushinteger(lua->getState(), 42);
+				lua->call<int>("increment");
+				total++;
+			}
+		}));
+	}
+	for (auto &it: threads) {
+		it.join();
+	}
+	EXPECT_EQ(error.load(), 0);
+	EXPECT_EQ(total.load(), int(nbThread * nbJob));
+	// All the states are given back, and each increment has been done one time.
+	int counter = 0;
+	etk::Vector<luaWrapper::LuaStatePool::Checkout> checkouts;
+	for (size_t iii=0; iii<pool.size(); ++iii) {
+		checkouts.pushBack(pool.tryCheckout(1000));
+		EXPECT_EQ(checkouts.back().isValid(), true);
+		counter += checkouts.back()->call<int>("increment") - 1;
+	}
+	EXPECT_EQ(counter, int(nbThread * nbJob));
+}
+
+TEST(TestLuaStatePool, allPinned) {
+	luaWrapper::LuaStatePool pool(1, testPoolSetup);
+	std::thread worker([&]() {
+		luaWrapper::LuaStatePool::Checkout lua = pool.checkoutPinned();
+		EXPECT_EQ(lua.isValid(), true);
+	});
+	worker.join();
+	EXPECT_EQ(pool.pinCount(), 1);
+	// The only state is pinned to another thread: fail instead of waiting forever.
+	EXPECT_THROW(pool.checkoutPinned(), etk::exception::RuntimeError);
+	EXPECT_EQ(pool.tryCheckout(1000).isValid(), false);
+	EXPECT_EQ(pool.pinCount(), 1);
+}
+
+TEST(TestLuaStatePool, unpinBeforeExit) {
+	luaWrapper::LuaStatePool pool(2, testPoolSetup);
+	etk::Vector<std::thread> threads;
+	for (size_t iii=0; iii<2; ++iii) {
+		threads.pushBack(std::thread([&]() {
+			{
+				luaWrapper::LuaStatePool::Checkout lua = pool.checkoutPinned();
+				lua->call<int>("increment");
+			}
+			pool.unpin();
+		}));
+	}
+	for (auto &it: threads) {
+		it.join();
+	}
+	// The pins are released: all the states can be used again.
+	EXPECT_EQ(pool.pinCount(), 0);
+	luaWrapper::LuaStatePool::Checkout lua1 = pool.tryCheckout(1000);
+	luaWrapper::LuaStatePool::Checkout lua2 = pool.tryCheckout(1000);
+	EXPECT_EQ(lua1.isValid(), true);
+	EXPECT_EQ(lua2.isValid(), true);
+}
@@ -0,0 +1,63 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <luaWrapper/PoolAllocator.hpp>
+#include <etest/etest.hpp>
+
+static const char* testMemoryLimitScript =
+	"function fill()\n"
+	"	local data = {}\n"
+	"	for iii=1,10000000 do data[iii] = 'elem' .. iii end\n"
+	"end\n"
+	"function add(a, b) return a + b end\n";
+
+TEST(TestMemoryLimit, usage) {
+	luaWrapper::Lua lua;
+	EXPECT_NE(lua.getMemoryUsage(), 0);
+	size_t usage = lua.getMemoryUsage();
+	lua.executeString("data = {} for iii=1,1000 do data[iii] = { iii } end");
+	EXPECT_EQ(lua.getMemoryUsage() > usage, true);
+	EXPECT_EQ(lua.getMemoryPeak() >= lua.getMemoryUsage(), true);
+	lua.executeString("data = nil");
+	lua_gc(lua.getState(), LUA_GCCOLLECT, 0);
+	EXPECT_EQ(lua.getMemoryPeak() > lua.getMemoryUsage(), true);
+	lua.resetMemoryPeak();
+	EXPECT_EQ(lua.getMemoryPeak(), lua.getMemoryUsage());
+}
+
+TEST(TestMemoryLimit, call) {
+	luaWrapper::Lua lua;
+	lua.executeString(testMemoryLimitScript);
+	lua.setMemoryLimit(lua.getMemoryUsage() + 1024*1024);
+	bool memoryError = false;
+	try {
+		lua.callVoid("fill");
+	} catch (luaWrapper::MemoryError& _error) {
+		memoryError = true;
+	}
+	EXPECT_EQ(memoryError, true);
+	EXPECT_EQ(lua.getMemoryPeak() <= lua.getMemoryLimit(), true);
+	// The state is still usable.
+	EXPECT_EQ(lua.call<int>("add", 20, 22), 42);
+	EXPECT_EQ(lua_gettop(lua.getState()), 0);
+}
+
+TEST(TestMemoryLimit, executeString) {
+	luaWrapper::PoolAllocator allocator;
+	luaWrapper::Lua lua(luaWrapper::PoolAllocator::allocate, &allocator);
+	lua.executeString(testMemoryLimitScript);
+	lua.setMemoryLimit(lua.getMemoryUsage() + 1024*1024);
+	bool memoryError = false;
+	try {
+		lua.executeString("fill()");
+	} catch (luaWrapper::MemoryError& _error) {
+		memoryError = true;
+	}
+	EXPECT_EQ(memoryError, true);
+	EXPECT_EQ(allocator.getStatistic().m_currentSize, lua.getMemoryUsage());
+	EXPECT_EQ(lua.call<int>("add", 20, 22), 42);
+}
@@ -0,0 +1,138 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <luaWrapper/NumericArray.hpp>
+#include <etest/etest.hpp>
+
+TEST(TestNumericArray, indexAndLen) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerNumericArrays(lua);
+	lua.executeString("array = Float64Array.new(3)\n"
+	                  "array[2] = 2.5\n"
+	                  "size = #array\n"
+	                  "first = array[1]\n"
+	                  "second = array[2]\n"
+	                  "outside = array[4]\n"
+	                  "ok = pcall(function() array[4] = 1 end)\n");
+	lua_getglobal(lua.getState(), "size");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 3);
+	lua_getglobal(lua.getState(), "first");
+	EXPECT_EQ(lua_tonumber(lua.getState(), -1), 0.0);
+	lua_getglobal(lua.getState(), "second");
+	EXPECT_EQ(lua_tonumber(lua.getState(), -1), 2.5);
+	lua_getglobal(lua.getState(), "outside");
+	EXPECT_EQ(lua_isnil(lua.getState(), -1), 1);
+	lua_getglobal(lua.getState(), "ok");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+	lua_settop(lua.getState(), 0);
+	// The C++ side see the same memory (aligned).
+	lua_getglobal(lua.getState(), "array");
+	luaWrapper::NumericArray<double>* array = luaWrapper::toNumericArray<double>(lua.getState(), -1);
+	EXPECT_EQ(array != null, true);
+	EXPECT_EQ(array->m_data[1], 2.5);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(array->m_data) % luaWrapper::NumericArray<double>::alignment, 0);
+	EXPECT_EQ(luaWrapper::toNumericArray<float>(lua.getState(), -1) == null, true);
+}
+
+TEST(TestNumericArray, reduction) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerNumericArrays(lua);
+	int32_t data[] = {4, -2, 7, 1, 3};
+	luaWrapper::pushNumericArray<int32_t>(lua.getState(), data, 5);
+	lua_setglobal(lua.getState(), "array");
+	lua.executeString("sum = array:sum()\n"
+	                  "dot = array:dot(array)\n"
+	                  "min = array:min()\n"
+	                  "max = array:max()\n"
+	                  "empty = Int32Array.new(0):min()\n");
+	lua_getglobal(lua.getState(), "sum");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 13);
+	lua_getglobal(lua.getState(), "dot");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 79);
+	lua_getglobal(lua.getState(), "min");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), -2);
+	lua_getglobal(lua.getState(), "max");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 7);
+	lua_getglobal(lua.getState(), "empty");
+	EXPECT_EQ(lua_isnil(lua.getState(), -1), 1);
+}
+
+TEST(TestNumericArray, inPlace) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerNumericArrays(lua);
+	lua.executeString("a = Float32Array.new({1, 2, 3, 4, 5})\n"
+	                  "b = Float32Array.new({5, 4, 3, 2, 1})\n"
+	                  "a:add(b):scale(0.5)\n" // 3 3 3 3 3
+	                  "a:add(1)\n" // 4 4 4 4 4
+	                  "a:lerp(b, 0.5)\n" // 4.5 4 3.5 3 2.5
+	                  "a:clamp(3, 4)\n" // 4 4 3.5 3 3
+	                  "sum = a:sum()\n"
+	                  "ok = pcall(a.add, a, Float32Array.new(2))\n"
+	                  "okType = pcall(a.add, a, Int32Array.new(5))\n");
+	lua_getglobal(lua.getState(), "sum");
+	EXPECT_EQ(lua_tonumber(lua.getState(), -1), 17.5);
+	lua_getglobal(lua.getState(), "ok");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+	lua_getglobal(lua.getState(), "okType");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+}
+
+TEST(TestNumericArray, invalid) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerNumericArrays(lua);
+	lua.executeString("local a = Float64Array.new(1)\n"
+	                  "okCall = pcall(a.__newindex, Int32Array.new(1), 1, 1)\n"
+	                  "okSize = pcall(Float64Array.new, math.maxinteger)\n");
+	// The metamethods check the type of the array (no write in an other userdata).
+	lua_getglobal(lua.getState(), "okCall");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+	// The size of the block does not overflow.
+	lua_getglobal(lua.getState(), "okSize");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+}
+
+TEST(TestNumericArray, aliasAndOverflow) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerNumericArrays(lua);
+	lua.executeString("local a = Float32Array.new({1, 2, 3})\n"
+	                  "a:add(a)\n" // 2 4 6
+	                  "a:lerp(a, 0.5)\n"
+	                  "aliasSum = a:sum()\n"
+	                  "local i = Int32Array.new({2147483647, -2147483648, 5})\n"
+	                  "i:add(1)\n" // wrap around: -2147483648 -2147483647 6
+	                  "wrapFirst = i[1]\n"
+	                  "local s = Int32Array.new({1000, -1000, 3})\n"
+	                  "s:scale(1e20)\n" // saturated
+	                  "scaleMax = s[1]\n"
+	                  "scaleMin = s[2]\n"
+	                  "s:lerp(Int32Array.new({0, 0, 0}), 0/0)\n" // NaN
+	                  "nanValue = s[3]\n"
+	                  "local l = Int64Array.new({math.maxinteger, 1})\n"
+	                  "longSum = l:sum() == math.mininteger\n" // wrap around as the lua integers
+	                  "local n = Int32Array.new(1)\n"
+	                  "n[1] = math.maxinteger\n"
+	                  "setMax = n[1]\n"
+	                  "local f = Float32Array.new(1)\n"
+	                  "f[1] = 1e300\n"
+	                  "setInf = f[1] == math.huge\n");
+	lua_getglobal(lua.getState(), "aliasSum");
+	EXPECT_EQ(lua_tonumber(lua.getState(), -1), 12.0);
+	lua_getglobal(lua.getState(), "wrapFirst");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), -2147483648LL);
+	lua_getglobal(lua.getState(), "scaleMax");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 2147483647);
+	lua_getglobal(lua.getState(), "scaleMin");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), -2147483648LL);
+	lua_getglobal(lua.getState(), "nanValue");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 0);
+	lua_getglobal(lua.getState(), "longSum");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 1);
+	lua_getglobal(lua.getState(), "setMax");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 2147483647);
+	lua_getglobal(lua.getState(), "setInf");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 1);
+}
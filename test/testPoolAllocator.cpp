@@ -0,0 +1,43 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <luaWrapper/PoolAllocator.hpp>
+#include <etest/etest.hpp>
+
+TEST(TestPoolAllocator, statistic) {
+	luaWrapper::PoolAllocator allocator;
+	{
+		luaWrapper::Lua lua(luaWrapper::PoolAllocator::allocate, &allocator);
+		lua.executeString("data = {}\n"
+		                  "for iii=1,1000 do data[iii] = { value = 'elem' .. iii } end\n"
+		                  "function getCount() return #data end");
+		EXPECT_EQ(lua.call<int>("getCount"), 1000);
+		const luaWrapper::PoolAllocator::Statistic& statistic = allocator.getStatistic();
+		EXPECT_NE(statistic.m_poolAllocation, 0);
+		EXPECT_NE(statistic.m_systemAllocation, 0);
+		EXPECT_NE(statistic.m_currentSize, 0);
+		EXPECT_EQ(statistic.m_peakSize >= statistic.m_currentSize, true);
+		EXPECT_EQ(statistic.m_failure, 0);
+	}
+	// All the memory is released with the state.
+	EXPECT_EQ(allocator.getStatistic().m_currentSize, 0);
+	EXPECT_EQ(allocator.getStatistic().m_allocation, allocator.getStatistic().m_free);
+}
+
+TEST(TestPoolAllocator, reuse) {
+	luaWrapper::PoolAllocator allocator;
+	luaWrapper::Lua lua(luaWrapper::PoolAllocator::allocate, &allocator);
+	lua.executeString("function churn() for iii=1,10000 do local value = { iii } end end");
+	lua.callVoid("churn");
+	lua_gc(lua.getState(), LUA_GCCOLLECT, 0);
+	size_t size = allocator.getStatistic().m_currentSize;
+	allocator.resetStatistic();
+	lua.callVoid("churn");
+	lua_gc(lua.getState(), LUA_GCCOLLECT, 0);
+	EXPECT_EQ(allocator.getStatistic().m_currentSize <= size, true);
+	EXPECT_NE(allocator.getStatistic().m_poolAllocation, 0);
+}
@@ -0,0 +1,93 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <luaWrapper/luaWrapperUtil.hpp>
+#include <etest/etest.hpp>
+
+namespace testProperty {
+	class Element {
+		public:
+			int m_value = 0;
+			int m_count = 0;
+			int getCount() const {
+				return m_count;
+			}
+			void setCount(int _value) {
+				m_count = _value;
+			}
+			int getDouble() const {
+				return m_value*2;
+			}
+	};
+	class Derived : public Element {
+		public:
+			int m_other = 0;
+	};
+}
+ETK_DECLARE_TYPE(testProperty::Element);
+ETK_DECLARE_TYPE(testProperty::Derived);
+
+static luaL_Reg testPropertyEmpty[] = {
+	{ NULL, NULL }
+};
+
+static luaWrapper::Property testPropertyElement[] = {
+	{ "value", luaWrapper::utils::get<testProperty::Element, int, &testProperty::Element::m_value>, luaWrapper::utils::set<testProperty::Element, int, &testProperty::Element::m_value> },
+	{ "count", luaWrapper::utils::get<testProperty::Element, int, &testProperty::Element::getCount>, luaWrapper::utils::set<testProperty::Element, int, &testProperty::Element::setCount> },
+	{ "double", luaWrapper::utils::get<testProperty::Element, int, &testProperty::Element::getDouble>, NULL },
+	{ NULL, NULL, NULL }
+};
+
+static luaWrapper::Property testPropertyDerived[] = {
+	{ "other", luaWrapper::utils::get<testProperty::Derived, int, &testProperty::Derived::m_other>, luaWrapper::utils::set<testProperty::Derived, int, &testProperty::Derived::m_other> },
+	{ NULL, NULL, NULL }
+};
+
+TEST(TestProperty, getSet) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerElement<testProperty::Element>(lua, "Element", NULL, testPropertyEmpty);
+	luaWrapper::setProperties<testProperty::Element>(lua.getState(), testPropertyElement);
+	lua_settop(lua.getState(), 0);
+	ememory::SharedPtr<testProperty::Element> element = ememory::makeShared<testProperty::Element>();
+	luaWrapper::push<testProperty::Element>(lua.getState(), element);
+	lua_setglobal(lua.getState(), "element");
+	lua.executeString("element.value = 21\n"
+	                  "element.count = element.count + 3\n"
+	                  "element.field = 'storage'\n"
+	                  "result = element.double\n"
+	                  "field = element.field\n"
+	                  "readOnly = pcall(function() element.double = 3 end)\n");
+	EXPECT_EQ(element->m_value, 21);
+	EXPECT_EQ(element->m_count, 3);
+	lua_getglobal(lua.getState(), "result");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 42);
+	// The other keys are still per-object fields.
+	lua_getglobal(lua.getState(), "field");
+	EXPECT_EQ(etk::String(lua_tostring(lua.getState(), -1)), "storage");
+	lua_getglobal(lua.getState(), "readOnly");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+}
+
+TEST(TestProperty, extendSealed) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerElement<testProperty::Element>(lua, "Element", NULL, testPropertyEmpty);
+	luaWrapper::registerElement<testProperty::Derived>(lua, "Derived", NULL, testPropertyEmpty);
+	luaWrapper::setProperties<testProperty::Element>(lua.getState(), testPropertyElement);
+	luaWrapper::extend<testProperty::Derived, testProperty::Element>(lua.getState());
+	luaWrapper::setProperties<testProperty::Derived>(lua.getState(), testPropertyDerived);
+	luaWrapper::seal<testProperty::Derived>(lua.getState());
+	lua_settop(lua.getState(), 0);
+	lua.executeString("derived = Derived.new()\n"
+	                  "derived.value = 1\n"
+	                  "derived.other = 2\n"
+	                  "result = derived.value + derived.other\n"
+	                  "sealed = pcall(function() derived.field = 3 end)\n");
+	lua_getglobal(lua.getState(), "result");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 3);
+	lua_getglobal(lua.getState(), "sealed");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+}
@@ -0,0 +1,101 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <etest/etest.hpp>
+
+namespace testRegistry {
+	class Element {
+		public:
+			int m_value = 0;
+			Element(int _value = 0) :
+			  m_value(_value) {
+				
+			}
+	};
+}
+ETK_DECLARE_TYPE(testRegistry::Element);
+
+static luaL_Reg testRegistryEmpty[] = {
+	{ NULL, NULL }
+};
+
+static ememory::SharedPtr<testRegistry::Element> allocatorOne(lua_State* _luaState) {
+	return ememory::makeShared<testRegistry::Element>(1);
+}
+
+static ememory::SharedPtr<testRegistry::Element> allocatorTwo(lua_State* _luaState) {
+	return ememory::makeShared<testRegistry::Element>(2);
+}
+
+TEST(TestRegistry, perState) {
+	luaWrapper::Lua lua1;
+	luaWrapper::Lua lua2;
+	luaWrapper::registerElement<testRegistry::Element>(lua1, "ElementOne", NULL, testRegistryEmpty, allocatorOne);
+	luaWrapper::registerElement<testRegistry::Element>(lua2, "ElementTwo", NULL, testRegistryEmpty, allocatorTwo);
+	lua_settop(lua1.getState(), 0);
+	lua_settop(lua2.getState(), 0);
+	EXPECT_EQ(etk::String(luaWrapper::getClassname<testRegistry::Element>(lua1.getState())), "ElementOne");
+	EXPECT_EQ(etk::String(luaWrapper::getClassname<testRegistry::Element>(lua2.getState())), "ElementTwo");
+	lua1.executeString("element = ElementOne.new()");
+	lua2.executeString("element = ElementTwo.new()");
+	lua_getglobal(lua1.getState(), "element");
+	lua_getglobal(lua2.getState(), "element");
+	EXPECT_EQ(luaWrapper::to<testRegistry::Element>(lua1.getState(), -1)->m_value, 1);
+	EXPECT_EQ(luaWrapper::to<testRegistry::Element>(lua2.getState(), -1)->m_value, 2);
+}
+
+static int testRegistryPush(lua_State* _luaState) {
+	luaWrapper::push<testRegistry::Element>(_luaState, ememory::makeShared<testRegistry::Element>(42));
+	return 1;
+}
+
+static int testRegistryCheck(lua_State* _luaState) {
+	luaWrapper::check<testRegistry::Element>(_luaState, 1);
+	return 0;
+}
+
+TEST(TestRegistry, notRegistered) {
+	luaWrapper::Lua lua1;
+	luaWrapper::Lua lua2;
+	luaWrapper::registerElement<testRegistry::Element>(lua1, "Element", NULL, testRegistryEmpty);
+	lua_settop(lua1.getState(), 0);
+	// Only registered in the first state.
+	EXPECT_EQ(luaWrapper::getClassname<testRegistry::Element>(lua2.getState()) == null, true);
+	lua_pushnil(lua2.getState());
+	EXPECT_EQ(luaWrapper::to<testRegistry::Element>(lua2.getState(), -1) == null, true);
+	lua_settop(lua2.getState(), 0);
+	lua_register(lua2.getState(), "pushElement", testRegistryPush);
+	lua_register(lua2.getState(), "checkElement", testRegistryCheck);
+	lua2.executeString("okPush, errorPush = pcall(pushElement)\n"
+	                   "okCheck = pcall(checkElement, {})\n");
+	lua_getglobal(lua2.getState(), "okPush");
+	EXPECT_EQ(lua_toboolean(lua2.getState(), -1), 0);
+	lua_getglobal(lua2.getState(), "errorPush");
+	EXPECT_NE(etk::String(lua_tostring(lua2.getState(), -1)).find("not been registered"), etk::String::npos);
+	lua_getglobal(lua2.getState(), "okCheck");
+	EXPECT_EQ(lua_toboolean(lua2.getState(), -1), 0);
+	luaWrapper::push<testRegistry::Element>(lua1.getState(), ememory::makeShared<testRegistry::Element>(42));
+	lua_setglobal(lua1.getState(), "element");
+	lua_getglobal(lua1.getState(), "element");
+	EXPECT_EQ(luaWrapper::to<testRegistry::Element>(lua1.getState(), -1)->m_value, 42);
+}
+
+TEST(TestRegistry, registerTwice) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerElement<testRegistry::Element>(lua, "Element", NULL, testRegistryEmpty);
+	lua_settop(lua.getState(), 0);
+	int metatable = luaWrapper::getBinding<testRegistry::Element>(lua.getState()).m_metatable;
+	EXPECT_THROW(luaWrapper::registerElement<testRegistry::Element>(lua, "ElementTwo", NULL, testRegistryEmpty), etk::exception::RuntimeError);
+	// The first registration is kept.
+	EXPECT_EQ(luaWrapper::getBinding<testRegistry::Element>(lua.getState()).m_metatable, metatable);
+	EXPECT_EQ(etk::String(luaWrapper::getClassname<testRegistry::Element>(lua.getState())), "Element");
+	lua_settop(lua.getState(), 0);
+	lua.executeString("element = Element.new()\n"
+	                  "isElement = getmetatable(element) == Element.metatable\n");
+	lua_getglobal(lua.getState(), "isElement");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 1);
+}
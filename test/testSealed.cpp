@@ -0,0 +1,74 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <luaWrapper/luaWrapperUtil.hpp>
+#include <etest/etest.hpp>
+
+namespace testSealed {
+	class Element {
+		public:
+			int m_value = 0;
+	};
+	class Derived : public Element {
+		public:
+			int m_other = 0;
+	};
+}
+ETK_DECLARE_TYPE(testSealed::Element);
+ETK_DECLARE_TYPE(testSealed::Derived);
+
+static luaL_Reg testSealedElement[] = {
+	{ "value", luaWrapper::utils::getSet<testSealed::Element, int, &testSealed::Element::m_value> },
+	{ NULL, NULL }
+};
+
+static luaL_Reg testSealedDerived[] = {
+	{ "other", luaWrapper::utils::getSet<testSealed::Derived, int, &testSealed::Derived::m_other> },
+	{ NULL, NULL }
+};
+
+TEST(TestSealed, method) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerElement<testSealed::Element>(lua, "Element", NULL, testSealedElement);
+	luaWrapper::seal<testSealed::Element>(lua.getState());
+	lua_settop(lua.getState(), 0);
+	lua.executeString("element = Element.new()\n"
+	                  "element:value(42)\n"
+	                  "result = element:value()\n"
+	                  "missing = element.missing\n");
+	lua_getglobal(lua.getState(), "result");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 42);
+	lua_getglobal(lua.getState(), "missing");
+	EXPECT_EQ(lua_isnil(lua.getState(), -1), 1);
+}
+
+TEST(TestSealed, newindex) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerElement<testSealed::Element>(lua, "Element", NULL, testSealedElement);
+	luaWrapper::seal<testSealed::Element>(lua.getState());
+	lua_settop(lua.getState(), 0);
+	lua.executeString("element = Element.new()\n"
+	                  "ok = pcall(function() element.field = 3 end)\n");
+	lua_getglobal(lua.getState(), "ok");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+}
+
+TEST(TestSealed, extend) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerElement<testSealed::Element>(lua, "Element", NULL, testSealedElement);
+	luaWrapper::registerElement<testSealed::Derived>(lua, "Derived", NULL, testSealedDerived);
+	luaWrapper::extend<testSealed::Derived, testSealed::Element>(lua.getState());
+	luaWrapper::seal<testSealed::Derived>(lua.getState());
+	lua_settop(lua.getState(), 0);
+	// The methods of the parent are found through the metatable of the metatable.
+	lua.executeString("derived = Derived.new()\n"
+	                  "derived:value(1)\n"
+	                  "derived:other(2)\n"
+	                  "result = derived:value() + derived:other()\n");
+	lua_getglobal(lua.getState(), "result");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 3);
+}
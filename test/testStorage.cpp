@@ -0,0 +1,70 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <luaWrapper/luaWrapperUtil.hpp>
+#include <etest/etest.hpp>
+
+namespace testStorage {
+	class Element {
+		public:
+			int m_value = 0;
+	};
+}
+ETK_DECLARE_TYPE(testStorage::Element);
+
+static luaL_Reg testStorageElement[] = {
+	{ "value", luaWrapper::utils::getSet<testStorage::Element, int, &testStorage::Element::m_value> },
+	{ NULL, NULL }
+};
+
+TEST(TestStorage, field) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerElement<testStorage::Element>(lua, "Element", NULL, testStorageElement);
+	lua_settop(lua.getState(), 0);
+	lua.executeString("first = Element.new()\n"
+	                  "second = Element.new()\n"
+	                  "first.name = 'first'\n"
+	                  "first:value(3)\n"
+	                  "result = first.name .. first:value()\n"
+	                  "missing = second.name\n");
+	lua_getglobal(lua.getState(), "result");
+	EXPECT_EQ(etk::String(lua_tostring(lua.getState(), -1)), "first3");
+	// The storage is per object.
+	lua_getglobal(lua.getState(), "missing");
+	EXPECT_EQ(lua_isnil(lua.getState(), -1), 1);
+	// The storage is the user value of the userdata.
+	lua_getglobal(lua.getState(), "first");
+	EXPECT_EQ(lua_getuservalue(lua.getState(), -1), LUA_TTABLE);
+}
+
+TEST(TestStorage, collected) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerElement<testStorage::Element>(lua, "Element", NULL, testStorageElement);
+	lua_settop(lua.getState(), 0);
+	ememory::SharedPtr<testStorage::Element> element = ememory::makeShared<testStorage::Element>();
+	luaWrapper::push<testStorage::Element>(lua.getState(), element);
+	lua_setglobal(lua.getState(), "element");
+	lua.executeString("element.name = 'element'");
+	// The userdata is collected with its storage: nothing stay in the registry.
+	lua.executeString("element = nil");
+	lua_gc(lua.getState(), LUA_GCCOLLECT, 0);
+	size_t usage = lua.getMemoryUsage();
+	for (int32_t iii=0; iii<100; ++iii) {
+		luaWrapper::push<testStorage::Element>(lua.getState(), element);
+		lua_setglobal(lua.getState(), "element");
+		lua.executeString("element.name = 'element' element = nil");
+		lua_gc(lua.getState(), LUA_GCCOLLECT, 0);
+	}
+	// (a leak would be at least 100 tables)
+	EXPECT_EQ(lua.getMemoryUsage() < usage + 1024, true);
+	// A new userdata of the same object start with an empty storage.
+	luaWrapper::push<testStorage::Element>(lua.getState(), element);
+	lua_setglobal(lua.getState(), "element");
+	lua.executeString("missing = element.name");
+	lua_getglobal(lua.getState(), "missing");
+	EXPECT_EQ(lua_isnil(lua.getState(), -1), 1);
+}
@@ -0,0 +1,55 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <luaWrapper/luaWrapperUtil.hpp>
+#include <etest/etest.hpp>
+
+static int testStringLength(lua_State* _luaState) {
+	luaWrapper::StringView data = luaWrapper::utils::check<luaWrapper::StringView>(_luaState, 1);
+	lua_pushinteger(_luaState, lua_Integer(data.size()));
+	return 1;
+}
+
+TEST(TestString, embeddedZero) {
+	luaWrapper::Lua lua;
+	lua_State* luaState = lua.getState();
+	etk::String data("a\0b", 3);
+	luaWrapper::utils::push<etk::String>(luaState, data);
+	size_t size = 0;
+	lua_tolstring(luaState, -1, &size);
+	EXPECT_EQ(size, 3);
+	EXPECT_EQ(luaWrapper::utils::check<etk::String>(luaState, -1) == data, true);
+	lua_pushnil(luaState);
+	EXPECT_EQ(luaWrapper::utils::to<etk::String>(luaState, -1).size(), 0);
+}
+
+TEST(TestString, view) {
+	luaWrapper::Lua lua;
+	lua_State* luaState = lua.getState();
+	lua_pushlstring(luaState, "log\0line", 8);
+	luaWrapper::StringView view = luaWrapper::utils::check<luaWrapper::StringView>(luaState, -1);
+	EXPECT_EQ(view.size(), 8);
+	// No copy: the view point in the lua string.
+	EXPECT_EQ(view.data(), lua_tostring(luaState, -1));
+	EXPECT_EQ(view == luaWrapper::StringView("log\0line", 8), true);
+	EXPECT_EQ(view.toString() == etk::String("log\0line", 8), true);
+	luaWrapper::utils::push<luaWrapper::StringView>(luaState, view);
+	EXPECT_EQ(lua_rawequal(luaState, -1, -2), 1);
+	lua_pushnil(luaState);
+	EXPECT_EQ(luaWrapper::utils::to<luaWrapper::StringView>(luaState, -1).empty(), true);
+}
+
+TEST(TestString, argument) {
+	luaWrapper::Lua lua;
+	lua_register(lua.getState(), "length", testStringLength);
+	lua.executeString("size = length(string.rep('x', 4096) .. '\\0' .. 'end')\n"
+	                  "ok = pcall(length, {})\n");
+	lua_getglobal(lua.getState(), "size");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 4100);
+	lua_getglobal(lua.getState(), "ok");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+}
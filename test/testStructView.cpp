@@ -0,0 +1,154 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <luaWrapper/StructView.hpp>
+#include <etest/etest.hpp>
+
+namespace testStructView {
+	class Particle {
+		public:
+			float m_x;
+			float m_speed;
+			int32_t m_life;
+			bool m_alive;
+	};
+}
+
+static luaWrapper::StructField testStructViewParticle[] = {
+	LUAW_STRUCT_FIELD(testStructView::Particle, m_x, "x"),
+	LUAW_STRUCT_FIELD(testStructView::Particle, m_speed, "speed"),
+	LUAW_STRUCT_FIELD(testStructView::Particle, m_life, "life"),
+	LUAW_STRUCT_FIELD(testStructView::Particle, m_alive, "alive"),
+	{ NULL, 0, luaWrapper::StructFieldType::typeFloat }
+};
+
+static etk::Vector<testStructView::Particle> testStructViewCreate() {
+	etk::Vector<testStructView::Particle> particles;
+	for (int iii=0; iii<4; ++iii) {
+		testStructView::Particle particle;
+		particle.m_x = float(iii);
+		particle.m_speed = 0.5f;
+		particle.m_life = 10;
+		particle.m_alive = true;
+		particles.pushBack(particle);
+	}
+	return particles;
+}
+
+TEST(TestStructView, readWrite) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerStruct<testStructView::Particle>(lua.getState(), testStructViewParticle);
+	etk::Vector<testStructView::Particle> particles = testStructViewCreate();
+	luaWrapper::pushStructView<testStructView::Particle>(lua.getState(), particles);
+	lua_setglobal(lua.getState(), "particles");
+	lua.executeString("size = #particles\n"
+	                  "for i=1,#particles do\n"
+	                  "  local p = particles[i]\n"
+	                  "  p.x = p.x + p.speed\n"
+	                  "  p.life = p.life - i\n"
+	                  "end\n"
+	                  "particles[2].alive = false\n"
+	                  "outside = particles[5]\n"
+	                  "okField = pcall(function() return particles[1].unknown end)\n");
+	lua_getglobal(lua.getState(), "size");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 4);
+	EXPECT_EQ(particles[0].m_x, 0.5f);
+	EXPECT_EQ(particles[3].m_x, 3.5f);
+	EXPECT_EQ(particles[3].m_life, 6);
+	EXPECT_EQ(particles[1].m_alive, false);
+	EXPECT_EQ(particles[2].m_alive, true);
+	lua_getglobal(lua.getState(), "outside");
+	EXPECT_EQ(lua_isnil(lua.getState(), -1), 1);
+	lua_getglobal(lua.getState(), "okField");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+}
+
+TEST(TestStructView, cursor) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerStruct<testStructView::Particle>(lua.getState(), testStructViewParticle);
+	etk::Vector<testStructView::Particle> particles = testStructViewCreate();
+	luaWrapper::pushStructView<testStructView::Particle>(lua.getState(), particles);
+	lua_setglobal(lua.getState(), "particles");
+	lua.executeString("local a = particles[1]\n"
+	                  "local b = particles[2]\n"
+	                  "shared = rawequal(a, b)\n"
+	                  "local first = particles:cursor(1)\n"
+	                  "local second = particles:cursor(2)\n"
+	                  "first.x = second.x + 10\n");
+	// view[i] always return the same cursor.
+	lua_getglobal(lua.getState(), "shared");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 1);
+	EXPECT_EQ(particles[0].m_x, 11.0f);
+	// A shrinked vector raise an error (not a read out of the vector).
+	lua.executeString("last = particles:cursor(4)");
+	particles.popBack();
+	lua.executeString("ok = pcall(function() return last.x end)");
+	lua_getglobal(lua.getState(), "ok");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+}
+
+TEST(TestStructView, getSet) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerStruct<testStructView::Particle>(lua.getState(), testStructViewParticle);
+	etk::Vector<testStructView::Particle> particles = testStructViewCreate();
+	luaWrapper::pushStructView<testStructView::Particle>(lua.getState(), particles);
+	lua_setglobal(lua.getState(), "particles");
+	// view[i] is the shared cursor: the write goes in the record 2.
+	lua.executeString("particles[1].x = particles[2].x + 10\n");
+	EXPECT_EQ(particles[0].m_x, 0.0f);
+	EXPECT_EQ(particles[1].m_x, 11.0f);
+	// get/set do not use the cursor.
+	lua.executeString("particles:set(1, 'x', particles:get(3, 'x') + 10)\n"
+	                  "life = particles:get(4, 'life')\n"
+	                  "okRange = pcall(particles.get, particles, 5, 'x')\n"
+	                  "okField = pcall(particles.set, particles, 1, 'unknown', 1)\n"
+	                  "okValue = pcall(particles.set, particles, 1, 'x', 'text')\n");
+	EXPECT_EQ(particles[0].m_x, 12.0f);
+	EXPECT_EQ(particles[2].m_x, 2.0f);
+	lua_getglobal(lua.getState(), "life");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 10);
+	lua_getglobal(lua.getState(), "okRange");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+	lua_getglobal(lua.getState(), "okField");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+	lua_getglobal(lua.getState(), "okValue");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+}
+
+TEST(TestStructView, readOnly) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerStruct<testStructView::Particle>(lua.getState(), testStructViewParticle);
+	const etk::Vector<testStructView::Particle> particles = testStructViewCreate();
+	luaWrapper::pushStructView<testStructView::Particle>(lua.getState(), particles);
+	lua_setglobal(lua.getState(), "particles");
+	lua.executeString("x = particles[3].x\n"
+	                  "ok = pcall(function() particles[1].x = 5 end)\n"
+	                  "okSet = pcall(particles.set, particles, 1, 'x', 5)\n");
+	lua_getglobal(lua.getState(), "x");
+	EXPECT_EQ(lua_tonumber(lua.getState(), -1), 2.0);
+	lua_getglobal(lua.getState(), "ok");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+	lua_getglobal(lua.getState(), "okSet");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+	EXPECT_EQ(particles[0].m_x, 0.0f);
+}
+
+TEST(TestStructView, invalid) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerStruct<testStructView::Particle>(lua.getState(), testStructViewParticle);
+	etk::Vector<testStructView::Particle> particles = testStructViewCreate();
+	luaWrapper::pushStructView<testStructView::Particle>(lua.getState(), particles);
+	lua_setglobal(lua.getState(), "particles");
+	// The metamethods check the type of their first argument.
+	lua.executeString("local cursor = particles[1]\n"
+	                  "okCursor = pcall(getmetatable(cursor).__newindex, io.stdout, 'x', 1)\n"
+	                  "okView = pcall(getmetatable(particles).__index, cursor, 1)\n");
+	lua_getglobal(lua.getState(), "okCursor");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+	lua_getglobal(lua.getState(), "okView");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+}
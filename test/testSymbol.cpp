@@ -0,0 +1,82 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <luaWrapper/Symbol.hpp>
+#include <etest/etest.hpp>
+
+namespace testSymbol {
+	enum {
+		eventClick,
+		eventHover
+	};
+}
+
+static int testSymbolDispatch(lua_State* _luaState) {
+	switch (luaWrapper::utils::check<luaWrapper::Symbol>(_luaState, 1).getId()) {
+		case testSymbol::eventClick:
+			lua_pushinteger(_luaState, 1);
+			break;
+		case testSymbol::eventHover:
+			lua_pushinteger(_luaState, 2);
+			break;
+		default:
+			lua_pushinteger(_luaState, 0);
+			break;
+	}
+	return 1;
+}
+
+TEST(TestSymbol, intern) {
+	luaWrapper::Lua lua;
+	lua_State* luaState = lua.getState();
+	// The IDs are dense, in the order of creation.
+	EXPECT_EQ(luaWrapper::internSymbol(luaState, "click").getId(), testSymbol::eventClick);
+	EXPECT_EQ(luaWrapper::internSymbol(luaState, "hover").getId(), testSymbol::eventHover);
+	EXPECT_EQ(luaWrapper::internSymbol(luaState, "click").getId(), testSymbol::eventClick);
+	EXPECT_EQ(luaWrapper::getSymbolName(luaState, luaWrapper::Symbol(testSymbol::eventHover)), "hover");
+	luaWrapper::utils::push<luaWrapper::Symbol>(luaState, luaWrapper::Symbol(testSymbol::eventClick));
+	EXPECT_EQ(etk::String(lua_tostring(luaState, -1)), "click");
+	EXPECT_EQ(luaWrapper::utils::to<luaWrapper::Symbol>(luaState, -1).getId(), testSymbol::eventClick);
+	// An unknown string is not added.
+	lua_pushstring(luaState, "unknown");
+	EXPECT_EQ(luaWrapper::toSymbol(luaState, -1).isValid(), false);
+	lua_pushinteger(luaState, 12);
+	EXPECT_EQ(luaWrapper::toSymbol(luaState, -1).isValid(), false);
+	EXPECT_EQ(luaWrapper::getSymbolName(luaState, luaWrapper::Symbol()), "");
+}
+
+TEST(TestSymbol, longString) {
+	luaWrapper::Lua lua;
+	lua_State* luaState = lua.getState();
+	etk::String name;
+	for (int iii=0; iii<100; ++iii) {
+		name.pushBack(char('a' + iii%26));
+	}
+	luaWrapper::Symbol symbol = luaWrapper::internSymbol(luaState, name);
+	// An other lua string with the same content (not the same address).
+	luaWrapper::utils::push<etk::String>(luaState, name);
+	EXPECT_EQ(luaWrapper::toSymbol(luaState, -1) == symbol, true);
+}
+
+TEST(TestSymbol, dispatch) {
+	luaWrapper::Lua lua;
+	luaWrapper::internSymbol(lua.getState(), "click");
+	luaWrapper::internSymbol(lua.getState(), "hover");
+	lua_register(lua.getState(), "dispatch", testSymbolDispatch);
+	lua.executeString("click = dispatch('click')\n"
+	                  "hover = dispatch('ho' .. 'ver')\n"
+	                  "other = dispatch('other')\n"
+	                  "ok = pcall(dispatch, 12)\n");
+	lua_getglobal(lua.getState(), "click");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 1);
+	lua_getglobal(lua.getState(), "hover");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 2);
+	lua_getglobal(lua.getState(), "other");
+	EXPECT_EQ(lua_tointeger(lua.getState(), -1), 0);
+	lua_getglobal(lua.getState(), "ok");
+	EXPECT_EQ(lua_toboolean(lua.getState(), -1), 0);
+}
@@ -0,0 +1,125 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <etest/etest.hpp>
+#include <cstring>
+
+namespace testType {
+	class Base {
+		public:
+			int m_value = 0;
+	};
+	class Derived : public Base {
+		
+	};
+	class Leaf : public Derived {
+		
+	};
+	class Other {
+		
+	};
+	class Counted {
+		public:
+			static int s_destroyed;
+			~Counted() {
+				s_destroyed++;
+			}
+	};
+	int Counted::s_destroyed = 0;
+}
+ETK_DECLARE_TYPE(testType::Base);
+ETK_DECLARE_TYPE(testType::Derived);
+ETK_DECLARE_TYPE(testType::Leaf);
+ETK_DECLARE_TYPE(testType::Other);
+ETK_DECLARE_TYPE(testType::Counted);
+
+static luaL_Reg testTypeEmpty[] = {
+	{ NULL, NULL }
+};
+
+static void registerTestType(luaWrapper::Lua& _lua) {
+	luaWrapper::registerElement<testType::Base>(_lua, "Base", NULL, testTypeEmpty);
+	luaWrapper::registerElement<testType::Derived>(_lua, "Derived", NULL, testTypeEmpty);
+	luaWrapper::registerElement<testType::Leaf>(_lua, "Leaf", NULL, testTypeEmpty);
+	luaWrapper::registerElement<testType::Other>(_lua, "Other", NULL, testTypeEmpty);
+	luaWrapper::extend<testType::Derived, testType::Base>(_lua.getState());
+	luaWrapper::extend<testType::Leaf, testType::Derived>(_lua.getState());
+	lua_settop(_lua.getState(), 0);
+}
+
+TEST(TestType, isDirect) {
+	luaWrapper::Lua lua;
+	registerTestType(lua);
+	luaWrapper::push<testType::Base>(lua.getState(), ememory::makeShared<testType::Base>());
+	EXPECT_EQ(luaWrapper::is<testType::Base>(lua.getState(), -1), true);
+	EXPECT_EQ(luaWrapper::is<testType::Base>(lua.getState(), -1, true), true);
+	EXPECT_EQ(luaWrapper::is<testType::Derived>(lua.getState(), -1), false);
+	EXPECT_EQ(luaWrapper::is<testType::Other>(lua.getState(), -1), false);
+	EXPECT_EQ(lua_gettop(lua.getState()), 1);
+}
+
+TEST(TestType, isExtend) {
+	luaWrapper::Lua lua;
+	registerTestType(lua);
+	ememory::SharedPtr<testType::Leaf> leaf = ememory::makeShared<testType::Leaf>();
+	leaf->m_value = 42;
+	luaWrapper::push<testType::Leaf>(lua.getState(), leaf);
+	EXPECT_EQ(luaWrapper::is<testType::Leaf>(lua.getState(), -1), true);
+	EXPECT_EQ(luaWrapper::is<testType::Derived>(lua.getState(), -1), true);
+	EXPECT_EQ(luaWrapper::is<testType::Base>(lua.getState(), -1), true);
+	EXPECT_EQ(luaWrapper::is<testType::Base>(lua.getState(), -1, true), false);
+	EXPECT_EQ(luaWrapper::is<testType::Other>(lua.getState(), -1), false);
+	EXPECT_EQ(luaWrapper::to<testType::Base>(lua.getState(), -1)->m_value, 42);
+	EXPECT_EQ(luaWrapper::to<testType::Other>(lua.getState(), -1), null);
+	EXPECT_EQ(lua_gettop(lua.getState()), 1);
+}
+
+TEST(TestType, isNotUserdata) {
+	luaWrapper::Lua lua;
+	registerTestType(lua);
+	lua_pushinteger(lua.getState(), 42);
+	lua_newtable(lua.getState());
+	lua_pushlightuserdata(lua.getState(), &lua);
+	lua_newuserdata(lua.getState(), 4);
+	EXPECT_EQ(luaWrapper::is<testType::Base>(lua.getState(), 1), false);
+	EXPECT_EQ(luaWrapper::is<testType::Base>(lua.getState(), 2), false);
+	EXPECT_EQ(luaWrapper::is<testType::Base>(lua.getState(), 3), false);
+	EXPECT_EQ(luaWrapper::is<testType::Base>(lua.getState(), 4), false);
+	EXPECT_EQ(lua_gettop(lua.getState()), 4);
+}
+
+TEST(TestType, foreignUserdata) {
+	luaWrapper::Lua lua;
+	registerTestType(lua);
+	luaWrapper::push<testType::Base>(lua.getState(), ememory::makeShared<testType::Base>());
+	// A userdata of another library that starts with the same bytes.
+	void* data = lua_newuserdata(lua.getState(), sizeof(luaWrapper::Userdata));
+	memcpy(data, lua_touserdata(lua.getState(), 1), sizeof(uint64_t));
+	EXPECT_EQ(luaWrapper::getUserdata(lua.getState(), 1) != null, true);
+	EXPECT_EQ(luaWrapper::getUserdata(lua.getState(), 2) == null, true);
+	EXPECT_EQ(luaWrapper::is<testType::Base>(lua.getState(), 2), false);
+	EXPECT_EQ(luaWrapper::toPointer<testType::Base>(lua.getState(), 2) == null, true);
+	EXPECT_EQ(lua_gettop(lua.getState()), 2);
+}
+
+TEST(TestType, gcFromScript) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerElement<testType::Counted>(lua, "Counted", NULL, testTypeEmpty);
+	lua_settop(lua.getState(), 0);
+	luaWrapper::push<testType::Counted>(lua.getState(), ememory::makeShared<testType::Counted>());
+	lua_setglobal(lua.getState(), "counted");
+	EXPECT_EQ(testType::Counted::s_destroyed, 0);
+	// The script can call the __gc of the metatable: the userdata is only destroyed one time.
+	lua.executeString("local gc = getmetatable(counted).__gc\n"
+	                  "gc(counted)\n"
+	                  "gc(counted)\n"
+	                  "gc({})\n"
+	                  "counted = nil\n");
+	EXPECT_EQ(testType::Counted::s_destroyed, 1);
+	lua_gc(lua.getState(), LUA_GCCOLLECT, 0);
+	EXPECT_EQ(testType::Counted::s_destroyed, 1);
+}
@@ -0,0 +1,114 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <etest/etest.hpp>
+
+namespace testValue {
+	class Vector {
+		public:
+			float m_x = 0.0f;
+			float m_y = 0.0f;
+			Vector(float _x = 0.0f, float _y = 0.0f) :
+			  m_x(_x),
+			  m_y(_y) {
+				
+			}
+	};
+	static int32_t g_counter = 0;
+	class Counted {
+		public:
+			etk::String m_name;
+			Counted() {
+				g_counter++;
+			}
+			Counted(const Counted& _obj) :
+			  m_name(_obj.m_name) {
+				g_counter++;
+			}
+			~Counted() {
+				g_counter--;
+			}
+	};
+}
+ETK_DECLARE_TYPE(testValue::Vector);
+ETK_DECLARE_TYPE(testValue::Counted);
+
+static luaL_Reg testValueVector[] = {
+	{ "x", luaWrapper::utils::getSetValue<testValue::Vector, float, &testValue::Vector::m_x> },
+	{ "y", luaWrapper::utils::getSetValue<testValue::Vector, float, &testValue::Vector::m_y> },
+	{ NULL, NULL }
+};
+
+static luaL_Reg testValueEmpty[] = {
+	{ NULL, NULL }
+};
+
+TEST(TestValue, pushCheck) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerValue<testValue::Vector>(lua, "Vector", NULL, testValueVector);
+	lua_settop(lua.getState(), 0);
+	testValue::Vector vec(1.0f, 2.0f);
+	luaWrapper::pushValue<testValue::Vector>(lua.getState(), vec);
+	// The value is copied.
+	vec.m_x = 42.0f;
+	EXPECT_EQ(luaWrapper::isValue<testValue::Vector>(lua.getState(), -1), true);
+	EXPECT_EQ(luaWrapper::isValue<testValue::Counted>(lua.getState(), -1), false);
+	EXPECT_EQ(luaWrapper::checkValue<testValue::Vector>(lua.getState(), -1).m_x, 1.0f);
+	EXPECT_EQ(luaWrapper::checkValue<testValue::Vector>(lua.getState(), -1).m_y, 2.0f);
+	// It is not an object userdata.
+	EXPECT_EQ(luaWrapper::getUserdata(lua.getState(), -1) == null, true);
+	lua_pushinteger(lua.getState(), 5);
+	EXPECT_EQ(luaWrapper::toValue<testValue::Vector>(lua.getState(), -1) == null, true);
+	lua_settop(lua.getState(), 0);
+}
+
+TEST(TestValue, script) {
+	luaWrapper::Lua lua;
+	luaWrapper::registerValue<testValue::Vector>(lua, "Vector", NULL, testValueVector);
+	lua_settop(lua.getState(), 0);
+	lua.executeString("function test() local vec = Vector.new() vec:x(20) vec:y(22) return vec:x() + vec:y() end");
+	EXPECT_EQ(lua.call<float>("test"), 42.0f);
+}
+
+TEST(TestValue, destructor) {
+	testValue::g_counter = 0;
+	{
+		luaWrapper::Lua lua;
+		luaWrapper::registerValue<testValue::Counted>(lua, "Counted", NULL, testValueEmpty);
+		lua_settop(lua.getState(), 0);
+		testValue::Counted value;
+		value.m_name = "hello";
+		luaWrapper::pushValue<testValue::Counted>(lua.getState(), value);
+		EXPECT_EQ(testValue::g_counter, 2);
+		EXPECT_EQ(luaWrapper::checkValue<testValue::Counted>(lua.getState(), -1).m_name, "hello");
+		lua_settop(lua.getState(), 0);
+		lua_gc(lua.getState(), LUA_GCCOLLECT, 0);
+		EXPECT_EQ(testValue::g_counter, 1);
+	}
+	EXPECT_EQ(testValue::g_counter, 0);
+}
+
+TEST(TestValue, gcFromScript) {
+	testValue::g_counter = 0;
+	{
+		luaWrapper::Lua lua;
+		luaWrapper::registerValue<testValue::Counted>(lua, "Counted", NULL, testValueEmpty);
+		lua_settop(lua.getState(), 0);
+		testValue::Counted value;
+		value.m_name = "a name longer than the small string buffer";
+		luaWrapper::pushValue<testValue::Counted>(lua.getState(), value);
+		lua_setglobal(lua.getState(), "value");
+		EXPECT_EQ(testValue::g_counter, 2);
+		// The script call the finalizer, then the GC call it again.
+		lua.executeString("value:__gc()\n"
+		                  "value:__gc()\n"
+		                  "value = nil\n"
+		                  "collectgarbage()\n");
+		EXPECT_EQ(testValue::g_counter, 1);
+	}
+	EXPECT_EQ(testValue::g_counter, 0);
+}
@@ -0,0 +1,117 @@
+/**
+ * @author Edouard DUPIN
+ * @copyright 2014, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <luaWrapper/luaWrapper.hpp>
+#include <luaWrapper/VectorView.hpp>
+#include <etest/etest.hpp>
+
+TEST(TestVectorView, read) {
+	luaWrapper::Lua lua;
+	lua_State* luaState = lua.getState();
+	etk::Vector<int> list;
+	for (int iii=0; iii<100000; ++iii) {
+		list.pushBack(iii);
+	}
+	luaWrapper::pushView<int>(luaState, list);
+	lua_setglobal(luaState, "list");
+	lua.executeString(R"#(
+	size = #list
+	first = list[1]
+	last = list[#list]
+	outside = list[#list + 1]
+	)#");
+	lua_getglobal(luaState, "size");
+	EXPECT_EQ(lua_tointeger(luaState, -1), 100000);
+	lua_getglobal(luaState, "first");
+	EXPECT_EQ(lua_tointeger(luaState, -1), 0);
+	lua_getglobal(luaState, "last");
+	EXPECT_EQ(lua_tointeger(luaState, -1), 99999);
+	lua_getglobal(luaState, "outside");
+	EXPECT_EQ(lua_isnil(luaState, -1), 1);
+}
+
+TEST(TestVectorView, iterate) {
+	luaWrapper::Lua lua;
+	lua_State* luaState = lua.getState();
+	etk::Vector<etk::String> list;
+	list.pushBack("a");
+	list.pushBack("b");
+	list.pushBack("c");
+	luaWrapper::pushView<etk::String>(luaState, list);
+	lua_setglobal(luaState, "list");
+	lua.executeString(R"#(
+	result = ""
+	for key, value in pairs(list) do
+		result = result .. key .. value
+	end
+	for key, value in ipairs(list) do
+		result = result .. key .. value
+	end
+	)#");
+	lua_getglobal(luaState, "result");
+	EXPECT_EQ(etk::String(lua_tostring(luaState, -1)), "1a2b3c1a2b3c");
+}
+
+TEST(TestVectorView, write) {
+	luaWrapper::Lua lua;
+	lua_State* luaState = lua.getState();
+	etk::Vector<int> list;
+	list.pushBack(1);
+	luaWrapper::pushView<int>(luaState, list);
+	lua_setglobal(luaState, "list");
+	const etk::Vector<int>& constList = list;
+	luaWrapper::pushView<int>(luaState, constList);
+	lua_setglobal(luaState, "constList");
+	lua.executeString(R"#(
+	list[1] = 42
+	list[#list + 1] = 43
+	outside = pcall(function() list[10] = 3 end)
+	readOnly = pcall(function() constList[1] = 3 end)
+	)#");
+	EXPECT_EQ(list.size(), size_t(2));
+	EXPECT_EQ(list[0], 42);
+	EXPECT_EQ(list[1], 43);
+	lua_getglobal(luaState, "outside");
+	EXPECT_EQ(lua_toboolean(luaState, -1), 0);
+	lua_getglobal(luaState, "readOnly");
+	EXPECT_EQ(lua_toboolean(luaState, -1), 0);
+}
+
+TEST(TestVectorView, destroyed) {
+	luaWrapper::Lua lua;
+	lua_State* luaState = lua.getState();
+	uint32_t generation = 0;
+	etk::Vector<int> list;
+	list.pushBack(1);
+	luaWrapper::pushView<int>(luaState, list, &generation);
+	lua_setglobal(luaState, "list");
+	generation++;
+	lua.executeString("ok = pcall(function() return list[1] end)");
+	lua_getglobal(luaState, "ok");
+	EXPECT_EQ(lua_toboolean(luaState, -1), 0);
+	lua_getglobal(luaState, "list");
+	EXPECT_EQ(luaWrapper::toVectorView<int>(luaState, -1) != null, true);
+	EXPECT_EQ(luaWrapper::toVectorView<float>(luaState, -1) == null, true);
+}
+
+TEST(TestVectorView, invalid) {
+	luaWrapper::Lua lua;
+	lua_State* luaState = lua.getState();
+	etk::Vector<int> list;
+	list.pushBack(1);
+	luaWrapper::pushView<int>(luaState, list);
+	lua_setglobal(luaState, "list");
+	// The functions reachable from the scripts check the type of the view.
+	lua.executeString(R"#(
+	local next = pairs(list)
+	okNext = pcall(next, io.stdout, 0)
+	okIndex = pcall(getmetatable(list).__newindex, io.stdout, 1, 1)
+	)#");
+	lua_getglobal(luaState, "okNext");
+	EXPECT_EQ(lua_toboolean(luaState, -1), 0);
+	lua_getglobal(luaState, "okIndex");
+	EXPECT_EQ(lua_toboolean(luaState, -1), 0);
+}